@@ -0,0 +1,23 @@
+#ifndef DISPARITY_CPU_BENCHMARK_HPP
+#define DISPARITY_CPU_BENCHMARK_HPP
+
+
+#include "Pixels.hpp"
+
+
+/// Measures the kernel variants against each other on the same input.
+namespace Benchmark {
+
+/// Runs the kernels of every variant supported by the CPU on the same images, and logs their run times
+/// and their speedups over the AVX2 variant (or over the scalar one, if AVX2 is not supported).
+/// \param leftPixels Left image data.
+/// \param rightPixels Right image data.
+/// \param window Window size.
+/// \param minD The first disparity to search.
+/// \param maxD The end of the searched disparity range, exclusive.
+void runKernels(const Pixelsf& leftPixels, const Pixelsf& rightPixels, int window, int minD, int maxD);
+
+}   // namespace Benchmark
+
+
+#endif //DISPARITY_CPU_BENCHMARK_HPP
@@ -0,0 +1,65 @@
+#ifndef DISPARITY_CPU_BOXFILTER_HPP
+#define DISPARITY_CPU_BOXFILTER_HPP
+
+
+#include "PixelCalc.hpp"
+#include "CostVolume.hpp"
+#include "MatchingCost.hpp"
+
+
+/// Window sum matching engine whose cost does not depend on the window size.
+/// For every disparity the image of the per-pixel cost terms (by default the products of the mean-centered
+/// inputs) is built once, then box-filtered with running column and row sums, so each score costs a constant
+/// number of operations.
+namespace BoxFilter {
+
+/// Finds the best disparity for every pixel of the left image.
+/// Gives the same results as evaluating the windows one by one, up to floating point rounding.
+/// Throws an `std::exception` if the aprons of the planes are smaller than required.
+/// \param leftCalc Precomputed data of the left image, with an apron of at least `window / 2`.
+/// \param rightCalc Precomputed data of the right image, with an apron of at least `window / 2 + maxD`.
+/// \param window Window size.
+/// \param minD The first disparity to search.
+/// \param maxD The end of the searched disparity range, exclusive.
+/// \param invertD Should be true, if the order of left and right pixel data is reversed.
+/// \param cost The matching cost, both images must have its planes.
+/// \return The disparity map.
+Pixelsi calcDepthMap(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD, int maxD,
+                     bool invertD, MatchingCost::Kind cost = MatchingCost::Kind::Zncc);
+
+/// Stores the score of every pixel of the left image at every disparity of a cost volume.
+/// Throws an `std::exception` if the volume and the images differ in size, or the aprons of the planes are
+/// smaller than required.
+/// \param leftCalc Precomputed data of the left image, with an apron of at least `window / 2`.
+/// \param rightCalc Precomputed data of the right image, with an apron of at least
+///                  `window / 2 + volume.getMaxD()`.
+/// \param window Window size.
+/// \param invertD Should be true, if the order of left and right pixel data is reversed.
+/// \param volume Output, its disparity range is searched.
+void calcCostVolume(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, bool invertD,
+                    CostVolume& volume);
+
+/// Finds the best disparity for every pixel of both images, moving down the image a row at a time.
+/// Only the product rows of the windows of the current row are kept, in a ring buffer of `window + 1` rows,
+/// together with their column sums. The scores and the left map are the same as the ones of `calcCostVolume`
+/// and `CostVolume::bestLeft`, the right map is the same as `CostVolume::bestRight`.
+/// Throws an `std::exception` if the aprons of the planes are smaller than required.
+/// \param leftCalc Precomputed data of the left image, with an apron of at least `window / 2`.
+/// \param rightCalc Precomputed data of the right image, with an apron of at least `window / 2 + maxD`.
+/// \param window Window size.
+/// \param minD The first disparity to search.
+/// \param maxD The end of the searched disparity range, exclusive.
+/// \return The disparity maps of both images.
+DepthMaps streamDepthMaps(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD, int maxD);
+
+/// Calculates the memory `streamDepthMaps` allocates for a band of rows, on top of the output maps.
+/// \param width The number of pixels in a row.
+/// \param window Window size.
+/// \param disparities The number of searched disparities.
+/// \return The size of the ring buffer and the column sums in bytes.
+size_t streamBytes(int width, int window, int disparities);
+
+}   // namespace BoxFilter
+
+
+#endif //DISPARITY_CPU_BOXFILTER_HPP
@@ -0,0 +1,47 @@
+#ifndef DISPARITY_CPU_CALIBRATION_HPP
+#define DISPARITY_CPU_CALIBRATION_HPP
+
+
+#include <istream>
+
+/// The disparities searched by the matching engines.
+struct DisparityRange {
+    int min;    ///< The first disparity to search.
+    int max;    ///< The end of the range, exclusive.
+};
+
+
+/// The fields of a Middlebury stereo calibration file (`calib.txt`) bounding the disparity search.
+class Calibration {
+public:
+    /// Reads a calibration file. If the file does not exist, or some fields are missing from it,
+    /// the search covers the default 260 disparities. Throws an `std::exception` if a field used is not a number.
+    /// \param filename The path of the calibration file.
+    /// \return The calibration.
+    static Calibration  load    (const char* filename);
+
+    /// Reads the `key=value` lines of a calibration file. Throws an `std::exception` if a field used
+    /// is not a number, or the fields give an empty range.
+    /// \param input The contents of the calibration file.
+    /// \return The calibration.
+    static Calibration  parse   (std::istream& input);
+
+    /// Checks if the calibration was read from a file.
+    /// \return False, if the defaults are used.
+    bool                loaded  () const { return m_loaded; }
+
+    /// Gets the disparity range containing the true disparities `[vmin, vmax]` of the scene,
+    /// scaled to the resolution of the matched images.
+    /// \param factor The full resolution images are shrunk by this factor before matching.
+    /// \return The range to search.
+    DisparityRange      range   (int factor) const;
+
+private:
+    bool    m_loaded = false;
+    int     m_ndisp = 260;
+    float   m_vmin = 0.0f;
+    float   m_vmax = 259.0f;
+};
+
+
+#endif //DISPARITY_CPU_CALIBRATION_HPP
@@ -0,0 +1,47 @@
+#ifndef DISPARITY_CPU_CENSUS_HPP
+#define DISPARITY_CPU_CENSUS_HPP
+
+
+#include <cstdint>
+#include "Pixels.hpp"
+#include "Kernels.hpp"
+
+
+/// Census transform matching engine. Every pixel is described by the comparisons with the other pixels of its
+/// window, packed into 64-bit words once per image, and a pair of pixels costs the number of differing bits.
+/// Unlike ZNCC it needs no window statistics, and the search runs without floating point arithmetic.
+namespace Census {
+
+/// The descriptors of an image, plane `i` holds word `i` of every pixel.
+using Descriptors = std::vector<Pixels<uint64_t>>;
+
+/// Gets the number of words a descriptor takes.
+/// \param window Window size.
+/// \return The number of 64-bit words holding a bit for every pixel of the window except the center, at least 1.
+int descriptorWords(int window);
+
+/// Calculates the census transform of an image. Bit `i` of a descriptor is set if pixel `i` of the window,
+/// counted in row-major order skipping the center, is darker than the center. Pixels outside the image
+/// repeat the edge values.
+/// \param pixels Image data.
+/// \param window Window size.
+/// \return The descriptors, `descriptorWords(window)` planes of the size of the image.
+Descriptors transform(const Pixelsf& pixels, int window);
+
+/// Finds the disparity with the lowest Hamming distance for every pixel of the left image.
+/// On equal distances the lower disparity wins.
+/// \param leftPixels Left image data.
+/// \param rightPixels Right image data.
+/// \param window Window size.
+/// \param minD The first disparity to search.
+/// \param maxD The end of the searched disparity range, exclusive.
+/// \param invertD Should be true, if the order of left and right pixel data is reversed.
+/// \param kernels The kernel variant to run.
+/// \return The disparity map.
+Pixelsi calcDepthMap(const Pixelsf& leftPixels, const Pixelsf& rightPixels, int window, int minD, int maxD,
+                     bool invertD, const Kernels::Table& kernels = Kernels::active());
+
+}   // namespace Census
+
+
+#endif //DISPARITY_CPU_CENSUS_HPP
@@ -3,18 +3,64 @@
 
 
 #include <memory>
+#include <string>
 
 
 // TODO documentation
 class CliOptions {
 public:
-    static void parse       (int argc, const char* argv[]);
-    static int  getThreads  ();
-    static int  getWindow   ();
+    /// Selects the implementation evaluating the matching scores in `DisparityAlgorithm::calcDepthMap`.
+    enum class Engine {
+        Window,         ///< Evaluates the full window for every pixel and disparity, a disparity at a time.
+        BoxFilter,      ///< Box-filters a product image per disparity. Independent of the window size.
+        SimdDisparity,  ///< Scores consecutive disparities of a pixel at once, as many as the vector lanes of
+                        ///< the active kernel variant, see `Kernels::active`.
+        SimdRow,        ///< Scores a disparity of adjacent pixels at once, as many as the vector lanes of the
+                        ///< active kernel variant, see `Kernels::active`.
+        Integer,        ///< Works on 8-bit images with integer vector instructions.
+        Census,         ///< Compares census transform descriptors by their Hamming distance instead of ZNCC.
+    };
+
+    static void                 parse           (int argc, const char* argv[]);
+    static int                  getThreads      ();
+    static int                  getWindow       ();
+    static int                  getDownscale    ();
+    static int                  getLevels       ();
+    static Engine               getEngine       ();
+    static const char*          getEngineName   ();
+    static const std::string&   getIsa          ();
+    static bool                 getBenchmark    ();
+    static bool                 getJoint        ();
+    static const std::string&   getCostVolume   ();
+    static const std::string&   getCostLayout   ();
+    static bool                 getStream       ();
+    static int                  getSgmPaths     ();
+    static const std::string&   getCost         ();
+    static bool                 getTiles        ();
+    static bool                 getWindowCache  ();
+    static float                getUniqueness   ();
+    static const std::string&   getSubPixel     ();
+    static bool                 getHugePages    ();
 
 private:
     static int threads;
     static int window;
+    static int downscale;
+    static int levels;
+    static Engine engine;
+    static std::string isa;
+    static bool benchmark;
+    static bool joint;
+    static std::string costVolume;
+    static std::string costLayout;
+    static bool stream;
+    static int sgmPaths;
+    static std::string cost;
+    static bool tiles;
+    static bool windowCache;
+    static float uniqueness;
+    static std::string subPixel;
+    static bool hugePages;
 };
 
 
@@ -0,0 +1,248 @@
+#ifndef DISPARITY_CPU_COSTVOLUME_HPP
+#define DISPARITY_CPU_COSTVOLUME_HPP
+
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include "Pixels.hpp"
+
+
+/// Stores the matching score of every pixel at every searched disparity, so later stages can work on the
+/// scores instead of recomputing them. Higher scores are better matches, as with ZNCC.
+class CostVolume {
+public:
+    /// The order of the elements in memory. Rows are always the outermost dimension.
+    enum class Layout {
+        DisparityInner, ///< The disparities of a pixel are adjacent, suits searching a pixel at a time.
+        ColumnInner,    ///< The pixels of a row at a disparity are adjacent, suits searching a disparity at a time.
+    };
+
+    /// The type the scores are stored as.
+    enum class Storage {
+        Float32,    ///< 32-bit floats, exact.
+        Float16,    ///< IEEE half precision floats, about 3 significant digits.
+        Int16,      ///< Fixed point, the range `[-1, 1]` is mapped to `[-32767, 32767]`. Other values are clamped.
+    };
+
+    /// A band of rows of a volume. Distinct bands can be written from different threads.
+    class Band {
+    public:
+        /// Gets the first row of the band.
+        /// \return The first row.
+        int getBegin() const noexcept { return m_begin; }
+
+        /// Gets the end of the band.
+        /// \return The row after the last row of the band.
+        int getEnd() const noexcept { return m_end; }
+
+        /// Gets a score. See `CostVolume::get`.
+        float get(int row, int col, int disp) const noexcept { return m_volume->get(row, col, disp); }
+
+        /// Sets a score. See `CostVolume::set`.
+        void set(int row, int col, int disp, float score) noexcept { m_volume->set(row, col, disp, score); }
+
+    private:
+        friend class CostVolume;
+
+        Band(CostVolume* volume, int begin, int end) noexcept :
+                m_volume    (volume),
+                m_begin     (begin),
+                m_end       (end)
+        {}
+
+        CostVolume* m_volume;
+        int m_begin;
+        int m_end;
+    };
+
+    /// Allocates a volume with all scores set to 0.
+    /// \param width The number of pixels in a row.
+    /// \param height The number of rows.
+    /// \param minD The first stored disparity.
+    /// \param maxD The end of the stored disparity range, exclusive.
+    /// \param layout The order of the elements in memory.
+    /// \param storage The type the scores are stored as.
+    CostVolume(int width, int height, int minD, int maxD, Layout layout, Storage storage);
+
+    /// Allocates a ring buffer of rows with all scores set to 0. It is accessed with image rows like a volume,
+    /// row `y` is stored in the slot `y mod rows`, so a band of `rows` consecutive rows can be kept while moving
+    /// down the image.
+    /// \param width The number of pixels in a row.
+    /// \param rows The number of rows kept.
+    /// \param minD The first stored disparity.
+    /// \param maxD The end of the stored disparity range, exclusive.
+    /// \param layout The order of the elements in memory.
+    /// \param storage The type the scores are stored as.
+    /// \return The ring buffer.
+    static CostVolume   ringBuffer          (int width, int rows, int minD, int maxD, Layout layout, Storage storage);
+
+    /// Calculates the memory a volume allocates, without allocating it.
+    /// \param width The number of pixels in a row.
+    /// \param height The number of rows.
+    /// \param disparities The number of stored disparities.
+    /// \param storage The type the scores are stored as.
+    /// \return The size of the score array in bytes.
+    static size_t       bytesRequired       (int width, int height, int disparities, Storage storage);
+
+    /// Selects a storage type by the name given in the `--cost-volume` option.
+    /// Throws an `std::exception` if the name is unknown.
+    /// \param name One of `fp32`, `fp16` and `int16`.
+    /// \return The storage type.
+    static Storage      parseStorage        (const std::string& name);
+
+    /// Selects a layout by the name given in the `--layout` option.
+    /// Throws an `std::exception` if the name is unknown.
+    /// \param name `disparity` or `column`, the innermost dimension.
+    /// \return The layout.
+    static Layout       parseLayout         (const std::string& name);
+
+    int         getWidth    () const noexcept { return m_width; }
+    int         getHeight   () const noexcept { return m_height; }
+    int         getMinD     () const noexcept { return m_minD; }
+    int         getMaxD     () const noexcept { return m_maxD; }
+    Layout      getLayout   () const noexcept { return m_layout; }
+    Storage     getStorage  () const noexcept { return m_storage; }
+
+    /// Gets the size of the allocated scores.
+    /// \return The size of the score array in bytes.
+    size_t getBytes() const noexcept { return bytesRequired(m_width, m_height, m_maxD - m_minD, m_storage); }
+
+    /// Gets a score, converted back from the storage type.
+    /// \param row The row of the left pixel.
+    /// \param col The column of the left pixel.
+    /// \param disp The disparity, in the range `[getMinD(), getMaxD())`.
+    /// \return The score.
+    float get(int row, int col, int disp) const noexcept {
+        const size_t i = index(row, col, disp);
+        switch (m_storage) {
+            case Storage::Float16:
+                return halfToFloat(m_compact[i]);
+            case Storage::Int16:
+                return static_cast<int16_t>(m_compact[i]) * (1.0f / INT16_SCALE);
+            default:
+                return m_floats[i];
+        }
+    }
+
+    /// Sets a score, rounded to the storage type.
+    /// \param row The row of the left pixel.
+    /// \param col The column of the left pixel.
+    /// \param disp The disparity, in the range `[getMinD(), getMaxD())`.
+    /// \param score The score.
+    void set(int row, int col, int disp, float score) noexcept {
+        const size_t i = index(row, col, disp);
+        switch (m_storage) {
+            case Storage::Float16:
+                m_compact[i] = floatToHalf(score);
+                break;
+            case Storage::Int16: {
+                const float clamped = std::min(std::max(score, -1.0f), 1.0f);
+                m_compact[i] = static_cast<uint16_t>(static_cast<int16_t>(std::lround(clamped * INT16_SCALE)));
+                break;
+            }
+            default:
+                m_floats[i] = score;
+        }
+    }
+
+    /// Gets the scores of a row at a disparity. Only valid with `Float32` storage and `ColumnInner` layout.
+    /// \param row The row.
+    /// \param disp The disparity, in the range `[getMinD(), getMaxD())`.
+    /// \return Pointer to the score of column 0, the scores of the row follow it.
+    float* scores(int row, int disp) noexcept { return &m_floats[index(row, 0, disp)]; }
+
+    /// Gets the scores of a pixel. Only valid with `Float32` storage and `DisparityInner` layout.
+    /// \param row The row of the left pixel.
+    /// \param col The column of the left pixel.
+    /// \return Pointer to the score of `getMinD()`, the scores of the other disparities follow it.
+    const float* pixelScores(int row, int col) const noexcept { return &m_floats[index(row, col, m_minD)]; }
+
+    /// Gets a view of a band of rows.
+    /// \param begin The first row of the band.
+    /// \param end The row after the last row of the band.
+    /// \return The view, it is valid as long as the volume is.
+    Band band(int begin, int end) noexcept { return Band(this, begin, end); }
+
+    /// Finds the best disparity of every left pixel. On equal scores the lower disparity wins.
+    /// \return The disparity map of the left image, `getMinD()` where no disparity scores above 0.
+    Pixelsi bestLeft() const;
+
+    /// Finds the best disparity of every right pixel. The score of right pixel `x` at disparity `d`
+    /// is the score of left pixel `x + d`, pairs with left pixels outside the image are skipped.
+    /// \return The disparity map of the right image, `getMinD()` where no disparity scores above 0.
+    Pixelsi bestRight() const;
+
+private:
+    static constexpr float INT16_SCALE = 32767.0f;
+
+    static uint16_t floatToHalf(float value) noexcept {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+        const int exponent = static_cast<int>((bits >> 23) & 0xffu) - 127 + 15;
+        uint32_t mantissa = bits & 0x7fffffu;
+        if (((bits >> 23) & 0xffu) == 0xffu) {
+            return static_cast<uint16_t>(sign | 0x7c00u | (mantissa != 0 ? 0x200u : 0u));
+        }
+        if (exponent >= 31) {
+            return static_cast<uint16_t>(sign | 0x7c00u);
+        }
+        // the dropped mantissa bits are rounded to nearest even, a carry may round up to the next exponent
+        int shift = 13;
+        uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+        if (exponent <= 0) {
+            if (exponent < -10) {
+                return sign;
+            }
+            mantissa |= 0x800000u;
+            shift = 14 - exponent;
+            half = mantissa >> shift;
+        }
+        const uint32_t rest = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1u) != 0)) {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    static float halfToFloat(uint16_t half) noexcept {
+        const uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+        const uint32_t exponent = (half >> 10) & 0x1fu;
+        const uint32_t mantissa = half & 0x3ffu;
+        if (exponent == 0) {
+            const float value = mantissa * (1.0f / 16777216.0f);
+            return sign != 0 ? -value : value;
+        }
+        const uint32_t bits = sign | (exponent == 31 ? 0x7f800000u : (exponent + 112) << 23) | (mantissa << 13);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    size_t index(int row, int col, int disp) const noexcept {
+        const int disparities = m_maxD - m_minD;
+        if (m_ring) {
+            row = (row % m_height + m_height) % m_height;
+        }
+        if (m_layout == Layout::DisparityInner) {
+            return (static_cast<size_t>(row) * m_width + col) * disparities + (disp - m_minD);
+        }
+        return (static_cast<size_t>(row) * disparities + (disp - m_minD)) * m_width + col;
+    }
+
+    int m_width;
+    int m_height;
+    int m_minD;
+    int m_maxD;
+    Layout m_layout;
+    Storage m_storage;
+    bool m_ring = false;
+    std::vector<float> m_floats;
+    std::vector<uint16_t> m_compact;
+};
+
+
+#endif //DISPARITY_CPU_COSTVOLUME_HPP
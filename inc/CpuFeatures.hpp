@@ -0,0 +1,29 @@
+#ifndef DISPARITY_CPU_CPUFEATURES_HPP
+#define DISPARITY_CPU_CPUFEATURES_HPP
+
+
+#include <cstddef>
+
+/// Queries the instruction set extensions of the CPU at runtime.
+namespace CpuFeatures {
+
+/// Instruction set levels the kernels are built for, in increasing order.
+enum class Isa {
+    Scalar,     ///< Portable code, no extensions required.
+    Avx,        ///< 256-bit floating point vectors and the `popcnt` instruction.
+    Avx2,       ///< 256-bit integer vectors and fused multiply-add.
+    Avx512,     ///< 512-bit vectors and mask registers (AVX-512 F, BW and VL).
+};
+
+/// Detects the highest instruction set level supported by both the CPU and the operating system.
+/// \return The detected level. Always `Isa::Scalar` on non-x86 platforms.
+Isa detect();
+
+/// Gets the size of the L2 cache of a core, which the tiled stages size their working sets by.
+/// \return The size in bytes, 256 KiB if it cannot be queried.
+size_t l2CacheSize();
+
+}   // namespace CpuFeatures
+
+
+#endif //DISPARITY_CPU_CPUFEATURES_HPP
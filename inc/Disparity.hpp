@@ -2,21 +2,86 @@
 #define DISPARITY_CPU_DISPARITY_HPP
 
 #include "Pixels.hpp"
+#include "Calibration.hpp"
 
 /// Provides functions to execute the disparity (ZNCC) algorithm and post-processing.
 namespace DisparityAlgorithm {
 
-/// Calculates the depth map from two input images.
+/// Calculates the depth map from two input images. The window and box filter engines use the matching cost
+/// selected by the `--cost` option, see `MatchingCost`.
 /// \param leftPixels Left image data.
 /// \param rightPixels Right image data.
+/// \param range The disparities to search.
 /// \param invertD Should be true, if the order of left and right pixel data is reversed.
 /// \return The depth map pixel data.
-Pixelsi calcDepthMap(const Pixelsf &leftPixels, const Pixelsf &rightPixels, bool invertD);
+Pixelsi calcDepthMap(const Pixelsf &leftPixels, const Pixelsf &rightPixels, const DisparityRange &range,
+                     bool invertD);
+
+/// Calculates the depth map from two 8-bit input images, using the integer matching engine.
+/// \param leftPixels Left image data.
+/// \param rightPixels Right image data.
+/// \param range The disparities to search.
+/// \param invertD Should be true, if the order of left and right pixel data is reversed.
+/// \return The depth map pixel data.
+Pixelsi calcDepthMap(const Pixelsb &leftPixels, const Pixelsb &rightPixels, const DisparityRange &range,
+                     bool invertD);
+
+/// Calculates the depth maps of both input images. With the `--stream` option both maps are found by
+/// `BoxFilter::streamDepthMaps`, with the `--sgm` option the scores of a `CostVolume` are smoothed by
+/// `Sgm::calcDepthMaps`, with the `--cost-volume` option they are extracted from a stored `CostVolume`,
+/// with the `--joint` option both come from a single correlation pass,
+/// see `SimdZncc::calcDepthMapsRowLanes`, otherwise `calcDepthMap` runs in both directions.
+/// \param leftPixels Left image data.
+/// \param rightPixels Right image data.
+/// \param range The disparities to search.
+/// \return The depth maps of the left and the right image.
+DepthMaps calcDepthMaps(const Pixelsf &leftPixels, const Pixelsf &rightPixels, const DisparityRange &range);
+
+/// Calculates the depth map of the left image with the confidence of every disparity, in a single pass of the
+/// window engine with the matching cost of the `--cost` option, see `WindowSweep::calcConfidentDepthMap`.
+/// Validating it by `uniquenessCheck` needs no right depth map.
+/// \param leftPixels Left image data.
+/// \param rightPixels Right image data.
+/// \param range The disparities to search.
+/// \return The depth map pixel data and the confidence of the pixels.
+ConfidentDepthMap calcConfidentDepthMap(const Pixelsf &leftPixels, const Pixelsf &rightPixels,
+                                        const DisparityRange &range);
+
+/// Refines a depth map to sub-pixel disparities with the method of the `--subpixel` option, by the scores of
+/// the matching cost of the `--cost` option, see `SubPixel::refine`.
+/// \param leftPixels Left image data.
+/// \param rightPixels Right image data.
+/// \param depthMap The depth map of the left image.
+/// \param range The searched disparities.
+/// \param invertD Should be true, if the order of left and right pixel data is reversed.
+/// \return The refined depth map pixel data.
+Pixelsf refineDepthMap(const Pixelsf &leftPixels, const Pixelsf &rightPixels, const Pixelsi &depthMap,
+                       const DisparityRange &range, bool invertD);
+
+/// Calculates the depth maps of both 8-bit input images, running `calcDepthMap` in both directions.
+/// \param leftPixels Left image data.
+/// \param rightPixels Right image data.
+/// \param range The disparities to search.
+/// \return The depth maps of the left and the right image.
+DepthMaps calcDepthMaps(const Pixelsb &leftPixels, const Pixelsb &rightPixels, const DisparityRange &range);
+
+/// Compares the kernel variants on two input images. See `Benchmark::runKernels`.
+/// \param leftPixels Left image data.
+/// \param rightPixels Right image data.
+/// \param range The disparities to search.
+void benchmarkKernels(const Pixelsf &leftPixels, const Pixelsf &rightPixels, const DisparityRange &range);
 
 /// Normalizes the output of the disparity algorithm. Ie. from 0-63 -> 0-255.
 /// \param input Input pixel data.
+/// \param range The searched disparities, the end of the range is mapped to 255.
 /// \return Normalized pixel data.
-Pixelsi normalize(const Pixelsi &input);
+Pixelsi normalize(const Pixelsi &input, const DisparityRange &range);
+
+/// Normalizes sub-pixel disparities like the integer ones, rounding to the nearest level.
+/// \param input Input pixel data.
+/// \param range The searched disparities, the end of the range is mapped to 255.
+/// \return Normalized pixel data.
+Pixelsi normalize(const Pixelsf &input, const DisparityRange &range);
 
 /// Runs cross-check post-processing algorithm.
 /// If a difference between the pixel values in the inputs is greater than a threshold, that pixel's value
@@ -26,6 +91,20 @@ Pixelsi normalize(const Pixelsi &input);
 /// \return CrossChecked output.
 Pixelsi crossCheck(const Pixelsi &in1, const Pixelsi &in2);
 
+/// Runs cross-check post-processing algorithm on sub-pixel disparities, see the integer version.
+/// \param in1 Input pixel data.
+/// \param in2 Input pixel data.
+/// \return CrossChecked output.
+Pixelsf crossCheck(const Pixelsf &in1, const Pixelsf &in2);
+
+/// Runs uniqueness check post-processing algorithm, a single map alternative of `crossCheck`.
+/// If the confidence of a pixel is less than the ratio, that pixel's value is going to be 0 in the output image.
+/// \param in Input pixel data.
+/// \param confidence The confidence of the input pixels.
+/// \param ratio The least confidence kept, in `[0, 1]`.
+/// \return Checked output.
+Pixelsi uniquenessCheck(const Pixelsi &in, const Pixelsf &confidence, float ratio);
+
 /// Runs occlusion fill post-processing algorithm.
 /// \param in Input pixel data.
 /// \return Occlusion filled output data.
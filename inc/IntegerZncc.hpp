@@ -0,0 +1,30 @@
+#ifndef DISPARITY_CPU_INTEGERZNCC_HPP
+#define DISPARITY_CPU_INTEGERZNCC_HPP
+
+
+#include "Pixels.hpp"
+#include "Kernels.hpp"
+
+
+/// ZNCC matching engine working on 8-bit images. Window sums and cross products are calculated with integer
+/// vector instructions, only the final normalization of the scores is done in floating point.
+/// Unlike the floating point engines, the windows are centered using the mean of the window center, which is
+/// the standard ZNCC formula.
+namespace IntegerZncc {
+
+/// Finds the best disparity for every pixel of the left image.
+/// \param leftPixels Left image data.
+/// \param rightPixels Right image data.
+/// \param window Window size.
+/// \param minD The first disparity to search.
+/// \param maxD The end of the searched disparity range, exclusive.
+/// \param invertD Should be true, if the order of left and right pixel data is reversed.
+/// \param kernels The kernel variant to run.
+/// \return The disparity map.
+Pixelsi calcDepthMap(const Pixelsb& leftPixels, const Pixelsb& rightPixels, int window, int minD, int maxD,
+                     bool invertD, const Kernels::Table& kernels = Kernels::active());
+
+}   // namespace IntegerZncc
+
+
+#endif //DISPARITY_CPU_INTEGERZNCC_HPP
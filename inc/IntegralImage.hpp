@@ -0,0 +1,55 @@
+#ifndef DISPARITY_CPU_INTEGRALIMAGE_HPP
+#define DISPARITY_CPU_INTEGRALIMAGE_HPP
+
+
+#include <vector>
+#include "Pixels.hpp"
+
+
+/// Summed-area table of a `Pixelsf` image. The source image is extended by a clamp-to-edge border
+/// before summing, so that window sums near the edges match the ones calculated by `Pixels::enumerateWindow`.
+class IntegralImage {
+public:
+    /// Builds the summed-area table.
+    /// \param pixels Source image.
+    /// \param border Width of the replicated border. Windows up to `2 * border + 1` in size can be queried.
+    /// \param squared If true, the squares of the pixel values are summed.
+    IntegralImage(const Pixelsf& pixels, int border, bool squared);
+
+    /// Returns the sum of the values in a window in O(1) time.
+    /// \param cx The center column of the window. Must be inside the source image.
+    /// \param cy The center row of the window. Must be inside the source image.
+    /// \param window Window size. Must not be greater than `2 * border + 1`.
+    /// \return The sum of the (squared) pixel values in the window.
+    double windowSum(int cx, int cy, int window) const noexcept {
+        const int d = window / 2;
+        const int left = cx + m_border - d;
+        const int top = cy + m_border - d;
+        const int right = left + window;
+        const int bottom = top + window;
+        return m_data[bottom * m_stride + right] - m_data[top * m_stride + right]
+             - m_data[bottom * m_stride + left] + m_data[top * m_stride + left];
+    }
+
+    /// Returns the table row above the windows centered in row `cy`. Index `cx` of the returned row belongs
+    /// to the left edge of the window centered on column `cx`, index `cx + window` to its right edge.
+    /// \param cy The center row of the windows. Must be inside the source image.
+    /// \param window Window size. Must not be greater than `2 * border + 1`.
+    /// \return Pointer into the table.
+    const double* windowTopRow(int cy, int window) const noexcept {
+        return &m_data[(cy + m_border - window / 2) * m_stride + m_border - window / 2];
+    }
+
+    /// Returns the table row at the bottom of the windows centered in row `cy`, indexed as in `windowTopRow`.
+    const double* windowBottomRow(int cy, int window) const noexcept {
+        return windowTopRow(cy, window) + window * m_stride;
+    }
+
+private:
+    std::vector<double> m_data;
+    const int           m_border;
+    const int           m_stride;
+};
+
+
+#endif //DISPARITY_CPU_INTEGRALIMAGE_HPP
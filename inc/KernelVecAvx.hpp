@@ -0,0 +1,162 @@
+#ifndef DISPARITY_CPU_KERNELVECAVX_HPP
+#define DISPARITY_CPU_KERNELVECAVX_HPP
+
+// 256-bit vector type of the AVX and AVX2 kernel variants. Fused multiply-add is used when the variant
+// is compiled with FMA enabled. Include `immintrin.h` first, then include this inside the namespace
+// of the variant, before `KernelsImpl.hpp`.
+
+
+constexpr int LANES = 8;
+
+using vfloat = __m256;
+using vmask = __m256;
+
+
+inline vfloat vset1(float value) { return _mm256_set1_ps(value); }
+inline vfloat vzero() { return _mm256_setzero_ps(); }
+inline vfloat vascending() { return _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7); }
+inline vfloat vload(const float* data) { return _mm256_loadu_ps(data); }
+inline vfloat vloadAligned(const float* data) { return _mm256_load_ps(data); }
+inline void vstore(float* data, vfloat a) { _mm256_storeu_ps(data, a); }
+inline vfloat vadd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+inline vfloat vsub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+inline vfloat vmul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+inline vfloat vmin(vfloat a, vfloat b) { return _mm256_min_ps(a, b); }
+inline vfloat vmax(vfloat a, vfloat b) { return _mm256_max_ps(a, b); }
+
+/// Returns `a * b + c`.
+inline vfloat vfmadd(vfloat a, vfloat b, vfloat c) {
+#if defined(__FMA__) || defined(__AVX2__)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+inline vmask vgreater(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline vmask vless(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline vmask vand(vmask a, vmask b) { return _mm256_and_ps(a, b); }
+
+/// Returns the lanes of `ifTrue` where `mask` is set, and the lanes of `ifFalse` elsewhere.
+inline vfloat vselect(vmask mask, vfloat ifTrue, vfloat ifFalse) { return _mm256_blendv_ps(ifFalse, ifTrue, mask); }
+
+/// Loads the lanes where `mask` is set, the other lanes are zero. Memory of the inactive lanes is not accessed.
+inline vfloat vloadMasked(const float* data, vmask mask) { return _mm256_maskload_ps(data, _mm256_castps_si256(mask)); }
+
+
+// 8-bit image products, accumulated in 32-bit integers. The bytes of two rows are widened to 16 bits and
+// interleaved, so a single multiply-add sums the products of both rows. AVX only has 128-bit integer
+// instructions, AVX2 processes 16 pixels at once.
+
+#ifdef __AVX2__
+
+constexpr int ILANES = 16;
+
+struct vpairacc {
+    __m256i lo, hi;
+};
+
+inline void vpairzero(vpairacc& acc) {
+    acc.lo = _mm256_setzero_si256();
+    acc.hi = _mm256_setzero_si256();
+}
+
+/// Adds `left0 * right0 + left1 * right1` of `ILANES` adjacent pixels of two row pairs to the sums.
+inline void vpairmadd(vpairacc& acc, const unsigned char* left0, const unsigned char* left1,
+                      const unsigned char* right0, const unsigned char* right1) {
+    const __m256i l0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(left0)));
+    const __m256i l1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(left1)));
+    const __m256i r0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(right0)));
+    const __m256i r1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(right1)));
+    acc.lo = _mm256_add_epi32(acc.lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(l0, l1), _mm256_unpacklo_epi16(r0, r1)));
+    acc.hi = _mm256_add_epi32(acc.hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(l0, l1), _mm256_unpackhi_epi16(r0, r1)));
+}
+
+/// Stores the sums in pixel order. The unpacks work within 128-bit halves, so `lo` holds the pixels
+/// 0-3 and 8-11, `hi` holds 4-7 and 12-15.
+inline void vpairstore(int* sums, const vpairacc& acc) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums), _mm256_permute2x128_si256(acc.lo, acc.hi, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums + 8), _mm256_permute2x128_si256(acc.lo, acc.hi, 0x31));
+}
+
+#else
+
+constexpr int ILANES = 8;
+
+struct vpairacc {
+    __m128i lo, hi;
+};
+
+inline void vpairzero(vpairacc& acc) {
+    acc.lo = _mm_setzero_si128();
+    acc.hi = _mm_setzero_si128();
+}
+
+/// Adds `left0 * right0 + left1 * right1` of `ILANES` adjacent pixels of two row pairs to the sums.
+inline void vpairmadd(vpairacc& acc, const unsigned char* left0, const unsigned char* left1,
+                      const unsigned char* right0, const unsigned char* right1) {
+    const __m128i l0 = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(left0)));
+    const __m128i l1 = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(left1)));
+    const __m128i r0 = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(right0)));
+    const __m128i r1 = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(right1)));
+    acc.lo = _mm_add_epi32(acc.lo, _mm_madd_epi16(_mm_unpacklo_epi16(l0, l1), _mm_unpacklo_epi16(r0, r1)));
+    acc.hi = _mm_add_epi32(acc.hi, _mm_madd_epi16(_mm_unpackhi_epi16(l0, l1), _mm_unpackhi_epi16(r0, r1)));
+}
+
+/// Stores the sums in pixel order.
+inline void vpairstore(int* sums, const vpairacc& acc) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(sums), acc.lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + 4), acc.hi);
+}
+
+#endif
+
+
+// Census descriptor distances, the number of differing bits of 64-bit words. AVX2 counts the bits of every
+// nibble with a table lookup and sums the bytes of the words, AVX only has the scalar `popcnt` instruction.
+
+/// Returns the number of set bits.
+inline int bitCount(uint64_t word) {
+#if defined(__x86_64__) || defined(_M_X64)
+    return static_cast<int>(_mm_popcnt_u64(word));
+#else
+    // 32-bit x86 only counts the bits of 32-bit words
+    return _mm_popcnt_u32(static_cast<unsigned>(word)) + _mm_popcnt_u32(static_cast<unsigned>(word >> 32));
+#endif
+}
+
+#ifdef __AVX2__
+
+constexpr int WLANES = 4;
+
+/// Adds the number of differing bits of `WLANES` adjacent word pairs to the distances.
+inline void vhammingadd(int* distances, const uint64_t* left, const uint64_t* right) {
+    const __m256i nibbleCounts = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                  0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibbles = _mm256_set1_epi8(0x0f);
+    const __m256i bits = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(left)),
+                                          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right)));
+    const __m256i byteCounts = _mm256_add_epi8(
+            _mm256_shuffle_epi8(nibbleCounts, _mm256_and_si256(bits, lowNibbles)),
+            _mm256_shuffle_epi8(nibbleCounts, _mm256_and_si256(_mm256_srli_epi16(bits, 4), lowNibbles)));
+    const __m256i wordCounts = _mm256_sad_epu8(byteCounts, _mm256_setzero_si256());
+    // the counts fit the low halves of the 64-bit lanes
+    const __m128i counts = _mm256_castsi256_si128(
+            _mm256_permutevar8x32_epi32(wordCounts, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+    __m128i* target = reinterpret_cast<__m128i*>(distances);
+    _mm_storeu_si128(target, _mm_add_epi32(_mm_loadu_si128(target), counts));
+}
+
+#else
+
+constexpr int WLANES = 4;
+
+/// Adds the number of differing bits of `WLANES` adjacent word pairs to the distances.
+inline void vhammingadd(int* distances, const uint64_t* left, const uint64_t* right) {
+    for (int i = 0; i < WLANES; ++i) { distances[i] += bitCount(left[i] ^ right[i]); }
+}
+
+#endif
+
+
+#endif //DISPARITY_CPU_KERNELVECAVX_HPP
@@ -0,0 +1,105 @@
+#ifndef DISPARITY_CPU_KERNELVECAVX512_HPP
+#define DISPARITY_CPU_KERNELVECAVX512_HPP
+
+// 512-bit vector type of the AVX-512 kernel variant. Masks live in mask registers, so masked loads
+// do not touch memory outside the active lanes. Include `immintrin.h` first, then include this inside
+// the namespace of the variant, before `KernelsImpl.hpp`.
+
+
+constexpr int LANES = 16;
+
+using vfloat = __m512;
+using vmask = __mmask16;
+
+
+inline vfloat vset1(float value) { return _mm512_set1_ps(value); }
+inline vfloat vzero() { return _mm512_setzero_ps(); }
+inline vfloat vascending() { return _mm512_set_ps(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0); }
+inline vfloat vload(const float* data) { return _mm512_loadu_ps(data); }
+inline vfloat vloadAligned(const float* data) { return _mm512_load_ps(data); }
+inline void vstore(float* data, vfloat a) { _mm512_storeu_ps(data, a); }
+inline vfloat vadd(vfloat a, vfloat b) { return _mm512_add_ps(a, b); }
+inline vfloat vsub(vfloat a, vfloat b) { return _mm512_sub_ps(a, b); }
+inline vfloat vmul(vfloat a, vfloat b) { return _mm512_mul_ps(a, b); }
+inline vfloat vmin(vfloat a, vfloat b) { return _mm512_min_ps(a, b); }
+inline vfloat vmax(vfloat a, vfloat b) { return _mm512_max_ps(a, b); }
+
+/// Returns `a * b + c`.
+inline vfloat vfmadd(vfloat a, vfloat b, vfloat c) { return _mm512_fmadd_ps(a, b, c); }
+
+inline vmask vgreater(vfloat a, vfloat b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+inline vmask vless(vfloat a, vfloat b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+inline vmask vand(vmask a, vmask b) { return static_cast<vmask>(a & b); }
+
+/// Returns the lanes of `ifTrue` where `mask` is set, and the lanes of `ifFalse` elsewhere.
+inline vfloat vselect(vmask mask, vfloat ifTrue, vfloat ifFalse) { return _mm512_mask_blend_ps(mask, ifFalse, ifTrue); }
+
+/// Loads the lanes where `mask` is set, the other lanes are zero. Memory of the inactive lanes is not accessed.
+inline vfloat vloadMasked(const float* data, vmask mask) { return _mm512_maskz_loadu_ps(mask, data); }
+
+
+// 8-bit image products, accumulated in 32-bit integers. The bytes of two rows are widened to 16 bits and
+// interleaved, so a single multiply-add (AVX-512 BW) sums the products of both rows for 16 pixels.
+
+constexpr int ILANES = 32;
+
+struct vpairacc {
+    __m512i lo, hi;
+};
+
+inline void vpairzero(vpairacc& acc) {
+    acc.lo = _mm512_setzero_si512();
+    acc.hi = _mm512_setzero_si512();
+}
+
+/// Adds `left0 * right0 + left1 * right1` of `ILANES` adjacent pixels of two row pairs to the sums.
+inline void vpairmadd(vpairacc& acc, const unsigned char* left0, const unsigned char* left1,
+                      const unsigned char* right0, const unsigned char* right1) {
+    const __m512i l0 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(left0)));
+    const __m512i l1 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(left1)));
+    const __m512i r0 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(right0)));
+    const __m512i r1 = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(right1)));
+    acc.lo = _mm512_add_epi32(acc.lo, _mm512_madd_epi16(_mm512_unpacklo_epi16(l0, l1), _mm512_unpacklo_epi16(r0, r1)));
+    acc.hi = _mm512_add_epi32(acc.hi, _mm512_madd_epi16(_mm512_unpackhi_epi16(l0, l1), _mm512_unpackhi_epi16(r0, r1)));
+}
+
+/// Stores the sums in pixel order. The unpacks work within 128-bit quarters, so quarter `q` of `lo` holds
+/// the pixels `8q` to `8q + 3`, and quarter `q` of `hi` holds `8q + 4` to `8q + 7`.
+inline void vpairstore(int* sums, const vpairacc& acc) {
+    const __m512i first = _mm512_shuffle_i32x4(acc.lo, acc.hi, 0x44);   // lo0 lo1 hi0 hi1
+    const __m512i second = _mm512_shuffle_i32x4(acc.lo, acc.hi, 0xee);  // lo2 lo3 hi2 hi3
+    _mm512_storeu_si512(sums, _mm512_shuffle_i32x4(first, first, 0xd8));        // lo0 hi0 lo1 hi1
+    _mm512_storeu_si512(sums + 16, _mm512_shuffle_i32x4(second, second, 0xd8)); // lo2 hi2 lo3 hi3
+}
+
+
+// Census descriptor distances, the number of differing bits of 64-bit words. The bits of every nibble are
+// counted with a table lookup (AVX-512 BW), then the bytes of the words are summed.
+
+/// Returns the number of set bits.
+inline int bitCount(uint64_t word) {
+#if defined(__x86_64__) || defined(_M_X64)
+    return static_cast<int>(_mm_popcnt_u64(word));
+#else
+    // 32-bit x86 only counts the bits of 32-bit words
+    return _mm_popcnt_u32(static_cast<unsigned>(word)) + _mm_popcnt_u32(static_cast<unsigned>(word >> 32));
+#endif
+}
+
+constexpr int WLANES = 8;
+
+/// Adds the number of differing bits of `WLANES` adjacent word pairs to the distances.
+inline void vhammingadd(int* distances, const uint64_t* left, const uint64_t* right) {
+    const __m512i nibbleCounts = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+    const __m512i lowNibbles = _mm512_set1_epi8(0x0f);
+    const __m512i bits = _mm512_xor_si512(_mm512_loadu_si512(left), _mm512_loadu_si512(right));
+    const __m512i byteCounts = _mm512_add_epi8(
+            _mm512_shuffle_epi8(nibbleCounts, _mm512_and_si512(bits, lowNibbles)),
+            _mm512_shuffle_epi8(nibbleCounts, _mm512_and_si512(_mm512_srli_epi16(bits, 4), lowNibbles)));
+    const __m256i counts = _mm512_cvtepi64_epi32(_mm512_sad_epu8(byteCounts, _mm512_setzero_si512()));
+    __m256i* target = reinterpret_cast<__m256i*>(distances);
+    _mm256_storeu_si256(target, _mm256_add_epi32(_mm256_loadu_si256(target), counts));
+}
+
+
+#endif //DISPARITY_CPU_KERNELVECAVX512_HPP
@@ -0,0 +1,161 @@
+#ifndef DISPARITY_CPU_KERNELVECSCALAR_HPP
+#define DISPARITY_CPU_KERNELVECSCALAR_HPP
+
+// Portable vector type of the scalar kernel variant. The fixed-size loops are left to the
+// auto-vectorizer of the compiler. Include inside the namespace of the variant, before `KernelsImpl.hpp`.
+
+
+constexpr int LANES = 8;
+
+struct vfloat {
+    float v[LANES];
+};
+
+struct vmask {
+    bool v[LANES];
+};
+
+
+inline vfloat vset1(float value) {
+    vfloat result;
+    for (int i = 0; i < LANES; ++i) { result.v[i] = value; }
+    return result;
+}
+
+inline vfloat vzero() {
+    return vset1(0.0f);
+}
+
+inline vfloat vascending() {
+    vfloat result;
+    for (int i = 0; i < LANES; ++i) { result.v[i] = static_cast<float>(i); }
+    return result;
+}
+
+inline vfloat vload(const float* data) {
+    vfloat result;
+    for (int i = 0; i < LANES; ++i) { result.v[i] = data[i]; }
+    return result;
+}
+
+inline vfloat vloadAligned(const float* data) {
+    return vload(data);
+}
+
+inline void vstore(float* data, const vfloat& a) {
+    for (int i = 0; i < LANES; ++i) { data[i] = a.v[i]; }
+}
+
+inline vfloat vadd(const vfloat& a, const vfloat& b) {
+    vfloat result;
+    for (int i = 0; i < LANES; ++i) { result.v[i] = a.v[i] + b.v[i]; }
+    return result;
+}
+
+inline vfloat vsub(const vfloat& a, const vfloat& b) {
+    vfloat result;
+    for (int i = 0; i < LANES; ++i) { result.v[i] = a.v[i] - b.v[i]; }
+    return result;
+}
+
+inline vfloat vmul(const vfloat& a, const vfloat& b) {
+    vfloat result;
+    for (int i = 0; i < LANES; ++i) { result.v[i] = a.v[i] * b.v[i]; }
+    return result;
+}
+
+inline vfloat vmin(const vfloat& a, const vfloat& b) {
+    vfloat result;
+    for (int i = 0; i < LANES; ++i) { result.v[i] = b.v[i] < a.v[i] ? b.v[i] : a.v[i]; }
+    return result;
+}
+
+inline vfloat vmax(const vfloat& a, const vfloat& b) {
+    vfloat result;
+    for (int i = 0; i < LANES; ++i) { result.v[i] = b.v[i] > a.v[i] ? b.v[i] : a.v[i]; }
+    return result;
+}
+
+/// Returns `a * b + c`.
+inline vfloat vfmadd(const vfloat& a, const vfloat& b, const vfloat& c) {
+    vfloat result;
+    for (int i = 0; i < LANES; ++i) { result.v[i] = a.v[i] * b.v[i] + c.v[i]; }
+    return result;
+}
+
+inline vmask vgreater(const vfloat& a, const vfloat& b) {
+    vmask result;
+    for (int i = 0; i < LANES; ++i) { result.v[i] = a.v[i] > b.v[i]; }
+    return result;
+}
+
+inline vmask vless(const vfloat& a, const vfloat& b) {
+    vmask result;
+    for (int i = 0; i < LANES; ++i) { result.v[i] = a.v[i] < b.v[i]; }
+    return result;
+}
+
+inline vmask vand(const vmask& a, const vmask& b) {
+    vmask result;
+    for (int i = 0; i < LANES; ++i) { result.v[i] = a.v[i] && b.v[i]; }
+    return result;
+}
+
+/// Returns the lanes of `ifTrue` where `mask` is set, and the lanes of `ifFalse` elsewhere.
+inline vfloat vselect(const vmask& mask, const vfloat& ifTrue, const vfloat& ifFalse) {
+    vfloat result;
+    for (int i = 0; i < LANES; ++i) { result.v[i] = mask.v[i] ? ifTrue.v[i] : ifFalse.v[i]; }
+    return result;
+}
+
+/// Loads the lanes where `mask` is set, the other lanes are zero. Memory of the inactive lanes is not accessed.
+inline vfloat vloadMasked(const float* data, const vmask& mask) {
+    vfloat result;
+    for (int i = 0; i < LANES; ++i) { result.v[i] = mask.v[i] ? data[i] : 0.0f; }
+    return result;
+}
+
+
+// 8-bit image products, accumulated in 32-bit integers.
+
+constexpr int ILANES = 8;
+
+struct vpairacc {
+    int v[ILANES];
+};
+
+inline void vpairzero(vpairacc& acc) {
+    for (int i = 0; i < ILANES; ++i) { acc.v[i] = 0; }
+}
+
+/// Adds `left0 * right0 + left1 * right1` of `ILANES` adjacent pixels of two row pairs to the sums.
+inline void vpairmadd(vpairacc& acc, const unsigned char* left0, const unsigned char* left1,
+                      const unsigned char* right0, const unsigned char* right1) {
+    for (int i = 0; i < ILANES; ++i) { acc.v[i] += left0[i] * right0[i] + left1[i] * right1[i]; }
+}
+
+/// Stores the sums in pixel order.
+inline void vpairstore(int* sums, const vpairacc& acc) {
+    for (int i = 0; i < ILANES; ++i) { sums[i] = acc.v[i]; }
+}
+
+
+// Census descriptor distances, the number of differing bits of 64-bit words.
+
+constexpr int WLANES = 4;
+
+/// Returns the number of set bits.
+inline int bitCount(uint64_t word) {
+    word -= (word >> 1) & 0x5555555555555555u;
+    word = (word & 0x3333333333333333u) + ((word >> 2) & 0x3333333333333333u);
+    word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fu;
+    return static_cast<int>((word * 0x0101010101010101u) >> 56);
+}
+
+/// Adds the number of differing bits of `WLANES` adjacent word pairs to the distances.
+inline void vhammingadd(int* distances, const uint64_t* left, const uint64_t* right) {
+    for (int i = 0; i < WLANES; ++i) { distances[i] += bitCount(left[i] ^ right[i]); }
+}
+
+
+#endif //DISPARITY_CPU_KERNELVECSCALAR_HPP
@@ -0,0 +1,209 @@
+#ifndef DISPARITY_CPU_KERNELS_HPP
+#define DISPARITY_CPU_KERNELS_HPP
+
+
+#include <cstdint>
+#include <vector>
+#include "CpuFeatures.hpp"
+
+
+/// The hot loops of the program, built in several instruction set variants. The variant is selected at
+/// runtime, so the binary runs on any x86 CPU and still uses the widest vectors available.
+///
+/// Kernels only work on raw arrays. Everything else (allocation, threading) is done by the callers,
+/// so no inline standard library code is compiled with extended instruction sets.
+namespace Kernels {
+
+/// Raw view of the row-padded planes of an image read by the matching kernels.
+/// Rows are not padded, the kernels clamp the row indices themselves.
+struct PlaneRows {
+    const float*    centered;   ///< The mean-centered image, pointing to row 0, column 0.
+    const float*    invStds;    ///< The reciprocal window deviation plane, pointing to row 0, column 0.
+    int             height;     ///< The number of rows.
+    int             stride;     ///< The distance between two rows in elements.
+};
+
+/// Raw view of the planes of a `WindowCache`, read by the matching kernels instead of the centered windows.
+struct WindowPlanes {
+    const float*    data;       ///< The plane of the first window element, pointing to row 0, column 0.
+    size_t          planeSize;  ///< The distance between two planes in elements.
+    int             stride;     ///< The distance between two rows in elements, a multiple of every vector width.
+};
+
+/// Raw view of the row-padded planes of an 8-bit image read by the integer matching kernels.
+/// Rows are not padded, the kernels clamp the row indices themselves.
+struct ByteRows {
+    const unsigned char*    pixels;     ///< The image, pointing to row 0, column 0.
+    const int*              sums;       ///< The window sums of the pixel values, pointing to row 0, column 0.
+    const float*            invDevs;    ///< Reciprocal of `sqrt(n * sum(x^2) - sum(x)^2)` of the windows, 0 if flat.
+    const unsigned char*    zeros;      ///< A row of zeros, with the same padding as the other rows.
+    int                     height;     ///< The number of rows.
+    int                     stride;     ///< The distance between two rows in elements.
+};
+
+/// The number of pixels the integer kernels may read beyond the end of a row, on top of the border
+/// required by the window and the disparities.
+constexpr int INTEGER_OVERREAD = 32;
+
+/// Window sizes with dedicated instantiations of the matching kernels, so their window loops are unrolled.
+/// Other window sizes use generic instantiations.
+constexpr int SPECIALIZED_WINDOWS[] = { 5, 7, 9, 11, 15, 21 };
+
+/// The matching kernels of a variant, instantiated for a window size and a search direction.
+struct Matchers {
+    /// Finds the best ZNCC disparities of a row, scoring consecutive disparities of a pixel in the vector lanes.
+    /// Partial vectors are handled with masked loads, so the planes need no padding for the vector width.
+    /// \param left Left image planes, padded by at least `window / 2` columns.
+    /// \param right Right image planes, padded by at least `window / 2 + maxD` columns.
+    /// \param row The row to match.
+    /// \param width The number of pixels in the row.
+    /// \param window Window size, the same as the one the kernels were selected for.
+    /// \param minD The first disparity to search. It is also the result, if no disparity scores above 0.
+    /// \param maxD The end of the searched disparity range, exclusive.
+    /// \param disparities Output, `width` elements.
+    void (*matchDisparityLanes)(const PlaneRows& left, const PlaneRows& right, int row, int width, int window,
+                                int minD, int maxD, int* disparities);
+
+    /// Same as `matchDisparityLanes`, but only searches a band of disparities around a predicted disparity
+    /// of every pixel. If no disparity in the band scores above 0, the prediction is kept.
+    /// \param predicted The predicted disparities of the row, `width` elements in the range `[minD, maxD)`.
+    /// \param band The search covers `[predicted - band, predicted + band]`, clipped to `[minD, maxD)`.
+    void (*matchDisparityBand)(const PlaneRows& left, const PlaneRows& right, int row, int width, int window,
+                               int minD, int maxD, const int* predicted, int band, int* disparities);
+
+    /// Finds the best ZNCC disparities of a row, scoring adjacent pixels in the vector lanes.
+    /// The parameters and the padding requirements are the same as for `matchDisparityLanes`.
+    void (*matchRowLanes)(const PlaneRows& left, const PlaneRows& right, int row, int width, int window,
+                          int minD, int maxD, int* disparities);
+
+    /// Same as `matchRowLanes`, but every score also updates the best disparity of the right pixel it pairs
+    /// with, so the disparities of the right image, searched in the opposite direction, come from the same
+    /// correlations. Pairs with left pixels outside the row are not scored for the right pixels.
+    /// \param rightDisparities Output, `width` elements, the disparities of the right row.
+    /// \param scratch `2 * width` elements, holding the running maximums of the right row.
+    void (*matchRowLanesBoth)(const PlaneRows& left, const PlaneRows& right, int row, int width, int window,
+                              int minD, int maxD, int* disparities, int* rightDisparities, float* scratch);
+
+    /// Same as `matchRowLanes`, but reads the window elements from the planes of window caches, the left ones
+    /// by aligned loads. Sums the products in the same order, so the results are the same.
+    /// \param leftWindows The window cache of the left centered plane, padded by at least `window / 2` columns.
+    /// \param rightWindows The window cache of the right centered plane, padded by at least `maxD` columns.
+    void (*matchRowLanesCached)(const PlaneRows& left, const PlaneRows& right, const WindowPlanes& leftWindows,
+                                const WindowPlanes& rightWindows, int row, int width, int window, int minD, int maxD,
+                                int* disparities);
+
+    /// Finds the best ZNCC disparities of a row of 8-bit images, scoring adjacent pixels in the vector lanes.
+    /// The window products are summed with 16-bit multiply-adds into 32-bit integers, only the final
+    /// normalization is done in floating point. The scores are the standard ZNCC of the windows.
+    /// The padding requirements are the same as for `matchDisparityLanes`, plus `INTEGER_OVERREAD` columns
+    /// on the right side of the rows.
+    void (*matchRowLanesInteger)(const ByteRows& left, const ByteRows& right, int row, int width, int window,
+                                 int minD, int maxD, int* disparities);
+};
+
+/// Function table of an instruction set variant.
+struct Table {
+    /// The name of the variant, as accepted by the `--isa` option.
+    const char* name;
+
+    /// The instruction set level required to run the variant.
+    CpuFeatures::Isa isa;
+
+    /// Converts an RGB image to grey and subsamples it.
+    /// \param rgb Interleaved 8-bit RGB source data.
+    /// \param width The width of the source image.
+    /// \param height The height of the source image.
+    /// \param factor Subsampling factor, every `factor`th pixel of every `factor`th row is kept.
+    /// \param grey Output, `(width / factor) * (height / factor)` elements.
+    void (*downsampleGrey)(const unsigned char* rgb, int width, int height, int factor, float* grey);
+
+    /// Same as `downsampleGrey`, but the output is rounded to 8 bits using fixed point arithmetic.
+    void (*downsampleGrey8)(const unsigned char* rgb, int width, int height, int factor, unsigned char* grey);
+
+    /// Adds a row of an integral image to the next one, `row[i] += above[i]`, the vertical pass of building
+    /// the table from the horizontal prefix sums.
+    /// \param above The previous row of the table.
+    /// \param row The row to add to, holding the prefix sums of its image row.
+    /// \param count The number of elements.
+    void (*accumulateRows)(const double* above, double* row, int count);
+
+    /// Computes the window statistics of a row from integral image rows.
+    /// For column `cx` the window sum is `bottom[cx + window] - top[cx + window] - bottom[cx] + top[cx]`.
+    /// \param sumsTop Integral image row above the windows.
+    /// \param sumsBottom Integral image row at the bottom of the windows.
+    /// \param squaresTop Squared integral image row above the windows.
+    /// \param squaresBottom Squared integral image row at the bottom of the windows.
+    /// \param pixels The image row.
+    /// \param width The number of pixels in the row.
+    /// \param window Window size.
+    /// \param means Output, window means.
+    /// \param centered Output, pixel values minus the window means.
+    /// \param invStds Output, reciprocal root of the squared deviation sums, 0 for flat windows.
+    void (*windowStatistics)(const double* sumsTop, const double* sumsBottom,
+                             const double* squaresTop, const double* squaresBottom,
+                             const float* pixels, int width, int window,
+                             float* means, float* centered, float* invStds);
+
+    /// Runs a step of semi-global matching along a path, for a pixel whose predecessor on the path is known.
+    /// With the matching cost `C = 1 - score`, sets
+    /// `current[d] = C[d] + min(previous[d], previous[d - 1] + p1, previous[d + 1] + p1, previousMin + p2) - previousMin`,
+    /// and adds it to `sums[d]`.
+    /// \param scores The matching scores of the pixel, `disparities` elements.
+    /// \param previous The path costs of the predecessor, `disparities` elements. `previous[-1]` and
+    ///                 `previous[disparities]` must be readable, and larger than any path cost.
+    /// \param previousMin The minimum of the path costs of the predecessor.
+    /// \param disparities The number of disparities.
+    /// \param p1 Penalty of a disparity change by 1.
+    /// \param p2 Penalty of larger disparity changes.
+    /// \param current Output, the path costs of the pixel, `disparities` elements.
+    /// \param sums The path costs summed over the paths, `disparities` elements.
+    /// \return The minimum of `current`.
+    float (*sgmStep)(const float* scores, const float* previous, float previousMin, int disparities, float p1,
+                     float p2, float* current, float* sums);
+
+    /// Adds the Hamming distances of census descriptor words to the distances of a row,
+    /// `distances[i] += popcount(left[i] ^ right[i])`.
+    /// \param left The words of the left pixels.
+    /// \param right The words of the paired right pixels.
+    /// \param count The number of pixels.
+    /// \param distances The distances, `count` elements.
+    void (*hammingDistances)(const uint64_t* left, const uint64_t* right, int count, int* distances);
+
+    /// Calculates the per-pixel terms of a window sum, `terms[i] = left[i] * right[i]`.
+    /// \param left The pixels of the left image.
+    /// \param right The paired pixels of the right image.
+    /// \param count The number of pixels.
+    /// \param terms Output, `count` elements.
+    void (*products)(const float* left, const float* right, int count, float* terms);
+
+    /// Same as `products`, with `terms[i] = |left[i] - right[i]|`.
+    void (*absDifferences)(const float* left, const float* right, int count, float* terms);
+
+    /// Same as `products`, with `terms[i] = (left[i] - right[i])^2`.
+    void (*squaredDifferences)(const float* left, const float* right, int count, float* terms);
+
+    /// Selects the matching kernels instantiated for a window size and a search direction.
+    /// \param window Window size. Sizes not in `SPECIALIZED_WINDOWS` get the generic instantiation.
+    /// \param invertD Should be true, if the order of left and right pixel data is reversed.
+    /// \return The matching kernels.
+    Matchers (*matchers)(int window, bool invertD);
+};
+
+/// Returns the variant selected by the `--isa` option. By default this is the best variant
+/// supported by the CPU. Throws an `std::exception` if the requested variant is unknown or not supported.
+/// \return The function table of the selected variant.
+const Table& active();
+
+/// Checks if the matching kernels have a dedicated instantiation for a window size.
+/// \param window Window size.
+/// \return True, if `window` is one of `SPECIALIZED_WINDOWS`.
+bool isSpecialized(int window);
+
+/// Lists the variants built into the binary that can run on this CPU.
+/// \return The function tables in increasing order of instruction set level.
+std::vector<const Table*> available();
+
+}   // namespace Kernels
+
+
+#endif //DISPARITY_CPU_KERNELS_HPP
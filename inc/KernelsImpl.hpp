@@ -0,0 +1,565 @@
+#ifndef DISPARITY_CPU_KERNELSIMPL_HPP
+#define DISPARITY_CPU_KERNELSIMPL_HPP
+
+// Instruction set independent implementation of the kernels declared in `Kernels.hpp`.
+// Included by every variant inside its own namespace, after one of the `KernelVec*.hpp` headers, which
+// provide the `vfloat` and `vmask` types, the `LANES` constant and the `v*` operations.
+// Standard headers must be included by the variant before opening its namespace.
+
+
+inline int clampRow(int row, int height) {
+    return row < 0 ? 0 : (row >= height ? height - 1 : row);
+}
+
+
+inline const float* centeredRow(const Kernels::PlaneRows& planes, int row) {
+    return planes.centered + clampRow(row, planes.height) * planes.stride;
+}
+
+
+inline const float* invStdRow(const Kernels::PlaneRows& planes, int row) {
+    return planes.invStds + clampRow(row, planes.height) * planes.stride;
+}
+
+
+void downsampleGrey(const unsigned char* rgb, int width, int height, int factor, float* grey) {
+    const float
+            R = 0.2126f,
+            G = 0.7152f,
+            B = 0.0722f;
+
+    const int outWidth = width / factor;
+    const int outHeight = height / factor;
+    for (int row = 0; row < outHeight; ++row) {
+        const unsigned char* source = rgb + static_cast<long long>(row) * factor * width * 3;
+        float* target = grey + row * outWidth;
+        for (int col = 0; col < outWidth; ++col) {
+            const unsigned char* pixel = source + col * factor * 3;
+            target[col] = pixel[0] * R + pixel[1] * G + pixel[2] * B;
+        }
+    }
+}
+
+
+void downsampleGrey8(const unsigned char* rgb, int width, int height, int factor, unsigned char* grey) {
+    // the weights of downsampleGrey in 16-bit fixed point, their sum is 1 << 16
+    const int
+            R = 13933,
+            G = 46871,
+            B = 4732;
+
+    const int outWidth = width / factor;
+    const int outHeight = height / factor;
+    for (int row = 0; row < outHeight; ++row) {
+        const unsigned char* source = rgb + static_cast<long long>(row) * factor * width * 3;
+        unsigned char* target = grey + row * outWidth;
+        for (int col = 0; col < outWidth; ++col) {
+            const unsigned char* pixel = source + col * factor * 3;
+            target[col] = static_cast<unsigned char>((pixel[0] * R + pixel[1] * G + pixel[2] * B + (1 << 15)) >> 16);
+        }
+    }
+}
+
+
+void accumulateRows(const double* above, double* row, int count) {
+    for (int i = 0; i < count; ++i) {
+        row[i] += above[i];
+    }
+}
+
+
+void windowStatistics(const double* sumsTop, const double* sumsBottom,
+                      const double* squaresTop, const double* squaresBottom,
+                      const float* pixels, int width, int window,
+                      float* means, float* centered, float* invStds) {
+    // squared deviation sums below this are rounding noise of a flat window
+    const double FLAT_LIMIT = 1e-6;
+    const double count = window * window;
+    for (int cx = 0; cx < width; ++cx) {
+        const double sum = sumsBottom[cx + window] - sumsTop[cx + window] - sumsBottom[cx] + sumsTop[cx];
+        const double squares = squaresBottom[cx + window] - squaresTop[cx + window]
+                               - squaresBottom[cx] + squaresTop[cx];
+        const auto mean = static_cast<float>(sum / count);
+        const double deviations = squares - sum * sum / count;
+        means[cx] = mean;
+        centered[cx] = pixels[cx] - mean;
+        invStds[cx] = deviations > FLAT_LIMIT ? static_cast<float>(1.0 / sqrt(deviations)) : 0.0f;
+    }
+}
+
+
+/// The window size of a kernel instantiation, `WINDOW` if it is specialized, the runtime `window` otherwise.
+template<int WINDOW>
+constexpr int windowSize(int window) {
+    return WINDOW != 0 ? WINDOW : window;
+}
+
+
+/// Reduces the per-lane maximums. On equal scores the lower disparity wins, same as in the scalar search.
+int reduceArgmax(vfloat scores, vfloat disparities) {
+    float laneScores[LANES];
+    float laneDisparities[LANES];
+    vstore(laneScores, scores);
+    vstore(laneDisparities, disparities);
+    float bestScore = laneScores[0];
+    float bestDisparity = laneDisparities[0];
+    for (int i = 1; i < LANES; ++i) {
+        if (laneScores[i] > bestScore || (laneScores[i] == bestScore && laneDisparities[i] < bestDisparity)) {
+            bestScore = laneScores[i];
+            bestDisparity = laneDisparities[i];
+        }
+    }
+    return static_cast<int>(bestDisparity);
+}
+
+
+/// Loads a vector, or only its active lanes if `MASKED` is set.
+template<bool MASKED>
+inline vfloat vloadLanes(const float* data, vmask mask) {
+    return MASKED ? vloadMasked(data, mask) : vload(data);
+}
+
+
+/// Loads a vector from an address aligned to the vector width, or only its active lanes if `MASKED` is set.
+template<bool MASKED>
+inline vfloat vloadAlignedLanes(const float* data, vmask mask) {
+    return MASKED ? vloadMasked(data, mask) : vloadAligned(data);
+}
+
+
+/// Scores `BLOCKS * LANES` consecutive disparities starting from `disp` at a single pixel, and updates
+/// the per-lane maximums. If `MASKED` is set, lanes belonging to disparities beyond `maxD` are not loaded,
+/// so the right planes do not need padding for them.
+template<int WINDOW, bool INVERT, int BLOCKS, bool MASKED>
+void scoreDisparities(const Kernels::PlaneRows& left, const Kernels::PlaneRows& right, int cx, int cy, int window,
+                      int disp, int maxD, vfloat& bestScores, vfloat& bestDisparities) {
+    const int r = windowSize<WINDOW>(window) / 2;
+    // lane i of block b is the disparity disp + b * LANES + i when inverted, and disp + b * LANES + LANES - 1 - i
+    // otherwise, so the lanes can be loaded from consecutive columns of the right image
+    const vfloat laneIndex = INVERT ? vascending() : vsub(vset1(LANES - 1), vascending());
+    const vfloat limit = vset1(static_cast<float>(maxD));
+    int firstCol[BLOCKS];
+    vfloat disparities[BLOCKS];
+    vmask valid[BLOCKS];
+    vfloat acc[BLOCKS];
+    for (int b = 0; b < BLOCKS; ++b) {
+        const int blockDisp = disp + b * LANES;
+        firstCol[b] = INVERT ? cx + blockDisp : cx - blockDisp - (LANES - 1);
+        disparities[b] = vadd(vset1(static_cast<float>(blockDisp)), laneIndex);
+        valid[b] = vless(disparities[b], limit);
+        acc[b] = vzero();
+    }
+
+    for (int row = cy - r; row <= cy + r; ++row) {
+        const float* leftRow = centeredRow(left, row);
+        const float* rightRow = centeredRow(right, row);
+        for (int col = -r; col <= r; ++col) {
+            const vfloat leftValue = vset1(leftRow[cx + col]);
+            for (int b = 0; b < BLOCKS; ++b) {
+                acc[b] = vfmadd(leftValue, vloadLanes<MASKED>(rightRow + firstCol[b] + col, valid[b]), acc[b]);
+            }
+        }
+    }
+
+    const vfloat leftInvStd = vset1(invStdRow(left, cy)[cx]);
+    for (int b = 0; b < BLOCKS; ++b) {
+        const vfloat rightInvStd = vloadLanes<MASKED>(invStdRow(right, cy) + firstCol[b], valid[b]);
+        const vfloat score = vmul(vmul(acc[b], leftInvStd), rightInvStd);
+        const vmask better = vand(vgreater(score, bestScores), valid[b]);
+        bestScores = vselect(better, score, bestScores);
+        bestDisparities = vselect(better, disparities[b], bestDisparities);
+    }
+}
+
+
+template<int WINDOW, bool INVERT>
+void matchDisparityLanes(const Kernels::PlaneRows& left, const Kernels::PlaneRows& right, int row, int width,
+                         int window, int minD, int maxD, int* disparities) {
+    for (int col = 0; col < width; ++col) {
+        vfloat bestScores = vzero();
+        vfloat bestDisparities = vset1(static_cast<float>(minD));
+        int disp = minD;
+        for (; disp + 2 * LANES <= maxD; disp += 2 * LANES) {
+            scoreDisparities<WINDOW, INVERT, 2, false>(left, right, col, row, window, disp, maxD,
+                                                       bestScores, bestDisparities);
+        }
+        for (; disp + LANES <= maxD; disp += LANES) {
+            scoreDisparities<WINDOW, INVERT, 1, false>(left, right, col, row, window, disp, maxD,
+                                                       bestScores, bestDisparities);
+        }
+        if (disp < maxD) {
+            scoreDisparities<WINDOW, INVERT, 1, true>(left, right, col, row, window, disp, maxD,
+                                                      bestScores, bestDisparities);
+        }
+        disparities[col] = reduceArgmax(bestScores, bestDisparities);
+    }
+}
+
+
+template<int WINDOW, bool INVERT>
+void matchDisparityBand(const Kernels::PlaneRows& left, const Kernels::PlaneRows& right, int row, int width,
+                        int window, int minD, int maxD, const int* predicted, int band, int* disparities) {
+    for (int col = 0; col < width; ++col) {
+        const int first = predicted[col] - band > minD ? predicted[col] - band : minD;
+        const int end = predicted[col] + band < maxD ? predicted[col] + band + 1 : maxD;
+        vfloat bestScores = vzero();
+        vfloat bestDisparities = vset1(static_cast<float>(predicted[col]));
+        // the end of the band is passed as the disparity limit, so the lanes beyond it are masked out
+        for (int disp = first; disp < end; disp += LANES) {
+            scoreDisparities<WINDOW, INVERT, 1, true>(left, right, col, row, window, disp, end,
+                                                      bestScores, bestDisparities);
+        }
+        disparities[col] = reduceArgmax(bestScores, bestDisparities);
+    }
+}
+
+
+/// The best disparities of the right pixels, found by the joint search from the scores of the left ones.
+struct RightBest {
+    float*  scores;         ///< The best scores, 0 if no disparity scored above 0 yet.
+    float*  disparities;    ///< The disparities of the best scores.
+    int     width;          ///< The number of pixels in the row.
+};
+
+
+/// Updates the best disparities of the right pixels paired with `count` adjacent left pixels at a disparity.
+/// \param rightCx The right column paired with the first lane.
+template<bool INVERT, bool MASKED>
+inline void updateRightBest(const RightBest& rightBest, vfloat score, int rightCx, int count, int disp) {
+    if (!INVERT && !MASKED && rightCx >= 0 && rightCx + LANES <= rightBest.width) {
+        // the disparities of a right pixel arrive in increasing order, so the first of equal scores is kept
+        const vfloat bestScores = vload(rightBest.scores + rightCx);
+        const vmask better = vgreater(score, bestScores);
+        vstore(rightBest.scores + rightCx, vselect(better, score, bestScores));
+        vstore(rightBest.disparities + rightCx, vselect(better, vset1(static_cast<float>(disp)),
+                                                        vload(rightBest.disparities + rightCx)));
+        return;
+    }
+
+    // at the ends of the row, and in the other direction, where the disparities arrive out of order
+    float laneScores[LANES];
+    vstore(laneScores, score);
+    const int first = rightCx < 0 ? -rightCx : 0;
+    const int end = rightCx + count > rightBest.width ? rightBest.width - rightCx : count;
+    for (int i = first; i < end; ++i) {
+        float& bestScore = rightBest.scores[rightCx + i];
+        float& bestDisparity = rightBest.disparities[rightCx + i];
+        if (laneScores[i] > bestScore || (laneScores[i] == bestScore && disp < bestDisparity)) {
+            bestScore = laneScores[i];
+            bestDisparity = static_cast<float>(disp);
+        }
+    }
+}
+
+
+/// Finds the best disparity of `LANES` adjacent pixels starting from column `cx`, and stores
+/// the results of the first `count` of them. If `MASKED` is set, only the first `count` lanes are loaded,
+/// so the planes do not need padding beyond the end of the row. If `BOTH` is set, every score also
+/// updates the running maximum of the right pixel it pairs with in `rightBest`.
+template<int WINDOW, bool INVERT, bool MASKED, bool BOTH>
+void matchAdjacentPixels(const Kernels::PlaneRows& left, const Kernels::PlaneRows& right, int cx, int cy, int count,
+                         int window, int minD, int maxD, int* disparities, const RightBest& rightBest) {
+    const int r = windowSize<WINDOW>(window) / 2;
+    const vmask valid = vless(vascending(), vset1(static_cast<float>(count)));
+    const vfloat leftInvStd = vloadLanes<MASKED>(invStdRow(left, cy) + cx, valid);
+    vfloat bestScores = vzero();
+    vfloat bestDisparities = vset1(static_cast<float>(minD));
+
+    for (int disp = minD; disp < maxD; ++disp) {
+        const int rightCx = INVERT ? cx + disp : cx - disp;
+        vfloat acc = vzero();
+        for (int row = cy - r; row <= cy + r; ++row) {
+            const float* leftRow = centeredRow(left, row) + cx;
+            const float* rightRow = centeredRow(right, row) + rightCx;
+            for (int col = -r; col <= r; ++col) {
+                acc = vfmadd(vloadLanes<MASKED>(leftRow + col, valid), vloadLanes<MASKED>(rightRow + col, valid), acc);
+            }
+        }
+        const vfloat rightInvStd = vloadLanes<MASKED>(invStdRow(right, cy) + rightCx, valid);
+        const vfloat score = vmul(vmul(acc, leftInvStd), rightInvStd);
+        const vmask better = vgreater(score, bestScores);
+        bestScores = vselect(better, score, bestScores);
+        bestDisparities = vselect(better, vset1(static_cast<float>(disp)), bestDisparities);
+
+        if (BOTH) {
+            updateRightBest<INVERT, MASKED>(rightBest, score, rightCx, count, disp);
+        }
+    }
+
+    float laneDisparities[LANES];
+    vstore(laneDisparities, bestDisparities);
+    for (int i = 0; i < count; ++i) {
+        disparities[i] = static_cast<int>(laneDisparities[i]);
+    }
+}
+
+
+/// Runs `matchAdjacentPixels` on every pixel of a row.
+template<int WINDOW, bool INVERT, bool BOTH>
+void matchRowPixels(const Kernels::PlaneRows& left, const Kernels::PlaneRows& right, int row, int width,
+                    int window, int minD, int maxD, int* disparities, const RightBest& rightBest) {
+    int col = 0;
+    for (; col + LANES <= width; col += LANES) {
+        matchAdjacentPixels<WINDOW, INVERT, false, BOTH>(left, right, col, row, LANES, window, minD, maxD,
+                                                         disparities + col, rightBest);
+    }
+    if (col < width) {
+        matchAdjacentPixels<WINDOW, INVERT, true, BOTH>(left, right, col, row, width - col, window, minD, maxD,
+                                                        disparities + col, rightBest);
+    }
+}
+
+
+template<int WINDOW, bool INVERT>
+void matchRowLanes(const Kernels::PlaneRows& left, const Kernels::PlaneRows& right, int row, int width,
+                   int window, int minD, int maxD, int* disparities) {
+    matchRowPixels<WINDOW, INVERT, false>(left, right, row, width, window, minD, maxD, disparities, RightBest());
+}
+
+
+/// Same as `matchAdjacentPixels` without `BOTH`, but reads the window elements from the window cache planes.
+/// `cx` is a multiple of `LANES`, so the left loads are aligned.
+template<int WINDOW, bool INVERT, bool MASKED>
+void matchAdjacentCached(const Kernels::PlaneRows& left, const Kernels::PlaneRows& right,
+                         const Kernels::WindowPlanes& leftWindows, const Kernels::WindowPlanes& rightWindows,
+                         int cx, int cy, int count, int window, int minD, int maxD, int* disparities) {
+    const int size = windowSize<WINDOW>(window);
+    const vmask valid = vless(vascending(), vset1(static_cast<float>(count)));
+    const vfloat leftInvStd = vloadLanes<MASKED>(invStdRow(left, cy) + cx, valid);
+    const float* leftPixels = leftWindows.data + cy * leftWindows.stride + cx;
+    const float* rightPixels = rightWindows.data + cy * rightWindows.stride;
+    vfloat bestScores = vzero();
+    vfloat bestDisparities = vset1(static_cast<float>(minD));
+
+    for (int disp = minD; disp < maxD; ++disp) {
+        const int rightCx = INVERT ? cx + disp : cx - disp;
+        vfloat acc = vzero();
+        // the elements are in row-major order, the same order as the window rows are summed
+        for (int element = 0; element < size * size; ++element) {
+            acc = vfmadd(vloadAlignedLanes<MASKED>(leftPixels + element * leftWindows.planeSize, valid),
+                         vloadLanes<MASKED>(rightPixels + element * rightWindows.planeSize + rightCx, valid), acc);
+        }
+        const vfloat rightInvStd = vloadLanes<MASKED>(invStdRow(right, cy) + rightCx, valid);
+        const vfloat score = vmul(vmul(acc, leftInvStd), rightInvStd);
+        const vmask better = vgreater(score, bestScores);
+        bestScores = vselect(better, score, bestScores);
+        bestDisparities = vselect(better, vset1(static_cast<float>(disp)), bestDisparities);
+    }
+
+    float laneDisparities[LANES];
+    vstore(laneDisparities, bestDisparities);
+    for (int i = 0; i < count; ++i) {
+        disparities[i] = static_cast<int>(laneDisparities[i]);
+    }
+}
+
+
+template<int WINDOW, bool INVERT>
+void matchRowLanesCached(const Kernels::PlaneRows& left, const Kernels::PlaneRows& right,
+                         const Kernels::WindowPlanes& leftWindows, const Kernels::WindowPlanes& rightWindows,
+                         int row, int width, int window, int minD, int maxD, int* disparities) {
+    int col = 0;
+    for (; col + LANES <= width; col += LANES) {
+        matchAdjacentCached<WINDOW, INVERT, false>(left, right, leftWindows, rightWindows, col, row, LANES, window,
+                                                   minD, maxD, disparities + col);
+    }
+    if (col < width) {
+        matchAdjacentCached<WINDOW, INVERT, true>(left, right, leftWindows, rightWindows, col, row, width - col,
+                                                  window, minD, maxD, disparities + col);
+    }
+}
+
+
+template<int WINDOW, bool INVERT>
+void matchRowLanesBoth(const Kernels::PlaneRows& left, const Kernels::PlaneRows& right, int row, int width,
+                       int window, int minD, int maxD, int* disparities, int* rightDisparities, float* scratch) {
+    const RightBest rightBest = { scratch, scratch + width, width };
+    for (int col = 0; col < width; ++col) {
+        rightBest.scores[col] = 0.0f;
+        rightBest.disparities[col] = static_cast<float>(minD);
+    }
+    matchRowPixels<WINDOW, INVERT, true>(left, right, row, width, window, minD, maxD, disparities, rightBest);
+    for (int col = 0; col < width; ++col) {
+        rightDisparities[col] = static_cast<int>(rightBest.disparities[col]);
+    }
+}
+
+
+inline const unsigned char* byteRow(const Kernels::ByteRows& planes, int row) {
+    return planes.pixels + clampRow(row, planes.height) * planes.stride;
+}
+
+
+template<int WINDOW, bool INVERT>
+void matchRowLanesInteger(const Kernels::ByteRows& left, const Kernels::ByteRows& right, int row, int width,
+                          int window, int minD, int maxD, int* disparities) {
+    const int r = windowSize<WINDOW>(window) / 2;
+    const long long count = (2 * r + 1) * (2 * r + 1);
+    const int* leftSums = left.sums + clampRow(row, left.height) * left.stride;
+    const float* leftInvDevs = left.invDevs + clampRow(row, left.height) * left.stride;
+    const int* rightSums = right.sums + clampRow(row, right.height) * right.stride;
+    const float* rightInvDevs = right.invDevs + clampRow(row, right.height) * right.stride;
+
+    for (int cx = 0; cx < width; cx += ILANES) {
+        const int lanes = width - cx < ILANES ? width - cx : ILANES;
+        float bestScores[ILANES] = {};
+        int bestDisparities[ILANES];
+        for (int i = 0; i < ILANES; ++i) {
+            bestDisparities[i] = minD;
+        }
+
+        for (int disp = minD; disp < maxD; ++disp) {
+            const int rightCx = INVERT ? cx + disp : cx - disp;
+            vpairacc acc;
+            vpairzero(acc);
+            // two window rows per multiply-add, an odd last row is paired with zeros
+            for (int y = row - r; y <= row + r; y += 2) {
+                const bool pair = y + 1 <= row + r;
+                const unsigned char* left0 = byteRow(left, y) + cx;
+                const unsigned char* left1 = (pair ? byteRow(left, y + 1) : left.zeros) + cx;
+                const unsigned char* right0 = byteRow(right, y) + rightCx;
+                const unsigned char* right1 = (pair ? byteRow(right, y + 1) : right.zeros) + rightCx;
+                for (int col = -r; col <= r; ++col) {
+                    vpairmadd(acc, left0 + col, left1 + col, right0 + col, right1 + col);
+                }
+            }
+
+            int products[ILANES];
+            vpairstore(products, acc);
+            for (int i = 0; i < ILANES; ++i) {
+                const long long numerator = count * products[i]
+                                            - static_cast<long long>(leftSums[cx + i]) * rightSums[rightCx + i];
+                const float score = static_cast<float>(numerator) * leftInvDevs[cx + i] * rightInvDevs[rightCx + i];
+                if (score > bestScores[i]) {
+                    bestScores[i] = score;
+                    bestDisparities[i] = disp;
+                }
+            }
+        }
+
+        for (int i = 0; i < lanes; ++i) {
+            disparities[cx + i] = bestDisparities[i];
+        }
+    }
+}
+
+
+float sgmStep(const float* scores, const float* previous, float previousMin, int disparities, float p1, float p2,
+              float* current, float* sums) {
+    const vfloat vPreviousMin = vset1(previousMin);
+    const vfloat vP1 = vset1(p1);
+    const vfloat jump = vset1(previousMin + p2);
+    const vfloat one = vset1(1.0f);
+    vfloat minimums = vset1(previous[-1]);
+    int d = 0;
+    for (; d + LANES <= disparities; d += LANES) {
+        const vfloat neighbours = vmin(vload(previous + d - 1), vload(previous + d + 1));
+        const vfloat best = vmin(vmin(vload(previous + d), vadd(neighbours, vP1)), jump);
+        const vfloat cost = vadd(vsub(one, vload(scores + d)), vsub(best, vPreviousMin));
+        vstore(current + d, cost);
+        vstore(sums + d, vadd(vload(sums + d), cost));
+        minimums = vmin(minimums, cost);
+    }
+
+    float laneMinimums[LANES];
+    vstore(laneMinimums, minimums);
+    float minimum = laneMinimums[0];
+    for (int i = 1; i < LANES; ++i) {
+        minimum = laneMinimums[i] < minimum ? laneMinimums[i] : minimum;
+    }
+    for (; d < disparities; ++d) {
+        const float neighbours = previous[d - 1] < previous[d + 1] ? previous[d - 1] : previous[d + 1];
+        float best = previous[d] < neighbours + p1 ? previous[d] : neighbours + p1;
+        best = best < previousMin + p2 ? best : previousMin + p2;
+        const float cost = (1.0f - scores[d]) + (best - previousMin);
+        current[d] = cost;
+        sums[d] += cost;
+        minimum = cost < minimum ? cost : minimum;
+    }
+    return minimum;
+}
+
+
+void hammingDistances(const uint64_t* left, const uint64_t* right, int count, int* distances) {
+    int i = 0;
+    for (; i + WLANES <= count; i += WLANES) {
+        vhammingadd(distances + i, left + i, right + i);
+    }
+    for (; i < count; ++i) {
+        distances[i] += bitCount(left[i] ^ right[i]);
+    }
+}
+
+
+/// Applies an operation to pixel pairs, `vop` to whole vectors and `op` to the rest.
+template<typename Tvop, typename Top>
+inline void pairTerms(const float* left, const float* right, int count, float* terms, const Tvop& vop, const Top& op) {
+    int i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        vstore(terms + i, vop(vload(left + i), vload(right + i)));
+    }
+    for (; i < count; ++i) {
+        terms[i] = op(left[i], right[i]);
+    }
+}
+
+
+void products(const float* left, const float* right, int count, float* terms) {
+    pairTerms(left, right, count, terms,
+              [](vfloat l, vfloat r) { return vmul(l, r); },
+              [](float l, float r) { return l * r; });
+}
+
+
+void absDifferences(const float* left, const float* right, int count, float* terms) {
+    pairTerms(left, right, count, terms,
+              [](vfloat l, vfloat r) { return vmax(vsub(l, r), vsub(r, l)); },
+              [](float l, float r) { return l > r ? l - r : r - l; });
+}
+
+
+void squaredDifferences(const float* left, const float* right, int count, float* terms) {
+    pairTerms(left, right, count, terms,
+              [](vfloat l, vfloat r) { const vfloat d = vsub(l, r); return vmul(d, d); },
+              [](float l, float r) { return (l - r) * (l - r); });
+}
+
+
+/// The matching kernels instantiated for a window size and a search direction. Window size 0 is the generic version.
+template<int WINDOW, bool INVERT>
+const Kernels::Matchers MATCHERS = {
+        matchDisparityLanes<WINDOW, INVERT>,
+        matchDisparityBand<WINDOW, INVERT>,
+        matchRowLanes<WINDOW, INVERT>,
+        matchRowLanesBoth<WINDOW, INVERT>,
+        matchRowLanesCached<WINDOW, INVERT>,
+        matchRowLanesInteger<WINDOW, INVERT>,
+};
+
+
+/// The specialized instantiations in the order of `Kernels::SPECIALIZED_WINDOWS`, indexed by the direction.
+const Kernels::Matchers SPECIALIZED_MATCHERS[][2] = {
+        { MATCHERS<5, false>,   MATCHERS<5, true> },
+        { MATCHERS<7, false>,   MATCHERS<7, true> },
+        { MATCHERS<9, false>,   MATCHERS<9, true> },
+        { MATCHERS<11, false>,  MATCHERS<11, true> },
+        { MATCHERS<15, false>,  MATCHERS<15, true> },
+        { MATCHERS<21, false>,  MATCHERS<21, true> },
+};
+
+static_assert(sizeof(SPECIALIZED_MATCHERS) / sizeof(SPECIALIZED_MATCHERS[0])
+              == sizeof(Kernels::SPECIALIZED_WINDOWS) / sizeof(Kernels::SPECIALIZED_WINDOWS[0]),
+              "every specialized window size needs its instantiations");
+
+
+Kernels::Matchers matchers(int window, bool invertD) {
+    for (int i = 0; i < sizeof(SPECIALIZED_MATCHERS) / sizeof(SPECIALIZED_MATCHERS[0]); ++i) {
+        if (Kernels::SPECIALIZED_WINDOWS[i] == window) {
+            return SPECIALIZED_MATCHERS[i][invertD];
+        }
+    }
+    return invertD ? MATCHERS<0, true> : MATCHERS<0, false>;
+}
+
+
+#endif //DISPARITY_CPU_KERNELSIMPL_HPP
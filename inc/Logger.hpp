@@ -3,12 +3,13 @@
 
 
 #include <chrono>
+#include <cstddef>
 
 
 /// Provides global logging and time-measurement functionality. Outputs to `stdout`.
 class Logger {
 public:
-    /// Logs global program settings : window size, worker thread count
+    /// Logs global program settings : window size, worker thread count, matching engine, kernel variant
     static void logInit         ();
 
     /// Logs about file loading.
@@ -21,6 +22,40 @@ public:
     /// \param filename
     static void logSave         (unsigned code, const char *filename);
 
+    /// Logs the searched disparity range.
+    /// \param filename The calibration file the range is read from.
+    /// \param loaded False, if the file could not be read and the default range is used.
+    /// \param minD The first searched disparity.
+    /// \param maxD The end of the searched disparity range, exclusive.
+    static void logCalibration  (const char *filename, bool loaded, int minD, int maxD);
+
+    /// Logs the memory a cost volume is going to allocate.
+    /// \param width The number of pixels in a row.
+    /// \param height The number of rows.
+    /// \param disparities The number of disparities stored per pixel.
+    /// \param storage The name of the storage type.
+    /// \param bytes The size of the volume.
+    static void logCostVolume   (int width, int height, int disparities, const char* storage, size_t bytes);
+
+    /// Logs the memory the streamed search is going to allocate.
+    /// \param width The number of pixels in a row.
+    /// \param rows The number of rows in the ring buffer of a thread.
+    /// \param disparities The number of disparities stored per pixel.
+    /// \param threads The number of threads, each with its own ring buffer.
+    /// \param bytes The size of all the ring buffers.
+    static void logStream       (int width, int rows, int disparities, int threads, size_t bytes);
+
+    /// Logs the memory the semi-global matching is going to allocate on top of the cost volume.
+    /// \param paths The number of path directions.
+    /// \param bytes The size of the path cost sums.
+    static void logSgm          (int paths, size_t bytes);
+
+    /// Logs the tiles the rows are dealt out in.
+    /// \param tileRows The number of rows in a tile.
+    /// \param tiles The number of tiles.
+    /// \param cacheBytes The cache size the tiles are sized for.
+    static void logTiles        (int tileRows, int tiles, size_t cacheBytes);
+
     /// Logs a message about the process started and starts the stopwatch.
     /// \param text Process description.
     static void startProgress   (const char* text);
@@ -32,6 +67,15 @@ public:
     /// Logs a message about a process end, also an execution time since `startProgress`.
     static void endProgress     ();
 
+    /// Logs the run time of a kernel variant.
+    /// \param kernel The name of the kernel.
+    /// \param variant The name of the kernel variant.
+    /// \param seconds The run time of the variant.
+    /// \param speedup The speedup of the variant over the baseline.
+    /// \param baseline The name of the baseline variant.
+    static void logBenchmark    (const char* kernel, const char* variant, float seconds, float speedup,
+                                 const char* baseline);
+
 private:
     static int m_lastBars;
     static const char* m_progressText;
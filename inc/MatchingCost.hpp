@@ -0,0 +1,203 @@
+#ifndef DISPARITY_CPU_MATCHINGCOST_HPP
+#define DISPARITY_CPU_MATCHINGCOST_HPP
+
+
+#include <limits>
+#include <string>
+#include "PixelCalc.hpp"
+#include "Kernels.hpp"
+
+
+/// The matching costs the window sum engines can be instantiated with. A cost is a class created for a band of
+/// rows, which provides:
+/// - `PLANES`, the `PixelCalc::Planes` it reads,
+/// - `WORST`, the score a disparity has to beat to be chosen over the first one,
+/// - `PERFECT`, the score of identical windows, the best one possible,
+/// - `terms(row, col, d, count, terms)`, the per-pixel terms of the pixels `[col, col + count)` of a left row
+///   paired with the right pixels `d` columns to the left, rows and columns within the apron can be read,
+/// - `score(sum, row, col, d)`, the score of a window from the sum of its terms, higher is better.
+namespace MatchingCost {
+
+/// The costs selectable with the `--cost` option.
+enum class Kind {
+    Zncc,   ///< Zero-mean normalized cross-correlation.
+    Sad,    ///< Sum of absolute differences.
+    Ssd,    ///< Sum of squared differences.
+    Census, ///< Sum of the Hamming distances of census descriptors.
+};
+
+/// Selects a cost by the name given in the `--cost` option.
+/// Throws an `std::exception` if the name is unknown.
+/// \param name One of `zncc`, `sad`, `ssd` and `census`.
+/// \return The cost.
+Kind parse(const std::string& name);
+
+/// Gets the planes a cost reads.
+/// \param kind The cost.
+/// \return The `PLANES` of the cost.
+unsigned planes(Kind kind);
+
+
+/// Zero-mean normalized cross-correlation, the products of the mean-centered pixels normalized by the
+/// deviations of both windows.
+class Zncc {
+public:
+    static constexpr unsigned PLANES = PixelCalc::StatisticsPlanes;
+    static constexpr float WORST = 0.0f;
+    static constexpr float PERFECT = 1.0f;
+
+    Zncc(const PixelCalc& left, const PixelCalc& right, const Kernels::Table& kernels) noexcept :
+            m_left      (left),
+            m_right     (right),
+            m_kernels   (kernels)
+    {}
+
+    void terms(int row, int col, int d, int count, float* terms) const {
+        m_kernels.products(m_left.centered().getRow(row) + col, m_right.centered().getRow(row) + col - d,
+                           count, terms);
+    }
+
+    float score(double sum, int row, int col, int d) const {
+        return static_cast<float>(sum) * m_left.invStds().getUnclamped(row, col)
+               * m_right.invStds().getUnclamped(row, col - d);
+    }
+
+private:
+    const PixelCalc& m_left;
+    const PixelCalc& m_right;
+    const Kernels::Table& m_kernels;
+};
+
+
+/// Sum of absolute differences of the pixel values. The score is the negated sum.
+class Sad {
+public:
+    static constexpr unsigned PLANES = PixelCalc::PaddedPlane;
+    static constexpr float WORST = -std::numeric_limits<float>::max();
+    static constexpr float PERFECT = 0.0f;
+
+    Sad(const PixelCalc& left, const PixelCalc& right, const Kernels::Table& kernels) noexcept :
+            m_left      (left),
+            m_right     (right),
+            m_kernels   (kernels)
+    {}
+
+    void terms(int row, int col, int d, int count, float* terms) const {
+        m_kernels.absDifferences(m_left.padded().getRow(row) + col, m_right.padded().getRow(row) + col - d,
+                                 count, terms);
+    }
+
+    float score(double sum, int, int, int) const { return -static_cast<float>(sum); }
+
+private:
+    const PixelCalc& m_left;
+    const PixelCalc& m_right;
+    const Kernels::Table& m_kernels;
+};
+
+
+/// Sum of squared differences of the pixel values. The score is the negated sum.
+class Ssd {
+public:
+    static constexpr unsigned PLANES = PixelCalc::PaddedPlane;
+    static constexpr float WORST = -std::numeric_limits<float>::max();
+    static constexpr float PERFECT = 0.0f;
+
+    Ssd(const PixelCalc& left, const PixelCalc& right, const Kernels::Table& kernels) noexcept :
+            m_left      (left),
+            m_right     (right),
+            m_kernels   (kernels)
+    {}
+
+    void terms(int row, int col, int d, int count, float* terms) const {
+        m_kernels.squaredDifferences(m_left.padded().getRow(row) + col, m_right.padded().getRow(row) + col - d,
+                                     count, terms);
+    }
+
+    float score(double sum, int, int, int) const { return -static_cast<float>(sum); }
+
+private:
+    const PixelCalc& m_left;
+    const PixelCalc& m_right;
+    const Kernels::Table& m_kernels;
+};
+
+
+/// Hamming distances of the census descriptors, summed over the window. The score is the negated sum.
+/// Keeps a buffer for the distances, so an instance must not be shared between threads.
+class Census {
+public:
+    static constexpr unsigned PLANES = PixelCalc::CensusPlanes;
+    static constexpr float WORST = -std::numeric_limits<float>::max();
+    static constexpr float PERFECT = 0.0f;
+
+    Census(const PixelCalc& left, const PixelCalc& right, const Kernels::Table& kernels) :
+            m_left      (left),
+            m_right     (right),
+            m_kernels   (kernels)
+    {}
+
+    void terms(int row, int col, int d, int count, float* terms) {
+        m_distances.assign(count, 0);
+        for (size_t word = 0; word < m_left.census().size(); ++word) {
+            m_kernels.hammingDistances(m_left.census()[word].getRow(row) + col,
+                                       m_right.census()[word].getRow(row) + col - d, count, m_distances.data());
+        }
+        std::copy(m_distances.begin(), m_distances.end(), terms);
+    }
+
+    float score(double sum, int, int, int) const { return -static_cast<float>(sum); }
+
+private:
+    const PixelCalc& m_left;
+    const PixelCalc& m_right;
+    const Kernels::Table& m_kernels;
+    std::vector<int> m_distances;
+};
+
+
+/// Sums the terms of a window pair row by row, the evaluation the window engines reproduce.
+/// \param cost The cost.
+/// \param window Window size.
+/// \param cx The center column of the left window.
+/// \param cy The center row of the windows.
+/// \param d The right window is `d` columns to the left.
+/// \param terms A buffer for a row of the window, `window` floats.
+/// \return The score of the window pair.
+template<typename Tcost>
+float windowScore(Tcost& cost, int window, int cx, int cy, int d, float* terms) {
+    const int D = window / 2;
+    float sum = 0.0f;
+    for (int row = cy - D; row <= cy + D; ++row) {
+        cost.terms(row, cx - D, d, window, terms);
+        for (int i = 0; i < window; ++i) {
+            sum += terms[i];
+        }
+    }
+    return cost.score(sum, cy, cx, d);
+}
+
+
+/// Calls a function with a null pointer to the cost class of a kind, so the caller can instantiate its
+/// templates with the cost selected at runtime.
+/// \param kind The cost.
+/// \param fun Called with a pointer of the cost class type, which is null.
+/// \return The result of `fun`.
+template<typename Tfun>
+auto dispatch(Kind kind, const Tfun& fun) {
+    switch (kind) {
+        case Kind::Sad:
+            return fun(static_cast<Sad*>(nullptr));
+        case Kind::Ssd:
+            return fun(static_cast<Ssd*>(nullptr));
+        case Kind::Census:
+            return fun(static_cast<Census*>(nullptr));
+        default:
+            return fun(static_cast<Zncc*>(nullptr));
+    }
+}
+
+}   // namespace MatchingCost
+
+
+#endif //DISPARITY_CPU_MATCHINGCOST_HPP
@@ -0,0 +1,103 @@
+#ifndef DISPARITY_CPU_MEMORY_HPP
+#define DISPARITY_CPU_MEMORY_HPP
+
+
+#include <cstddef>
+#include <vector>
+#include <new>
+
+
+/// Cache line aligned memory for the image planes and the buffers the kernels stream through.
+namespace Memory {
+
+/// The alignment of every block, a cache line.
+constexpr size_t CACHE_LINE = 64;
+
+/// The size of a transparent huge page on x86-64 Linux.
+constexpr size_t HUGE_PAGE = 2 * 1024 * 1024;
+
+/// Allocates a block aligned to `CACHE_LINE`. With the `--huge-pages` option, blocks of at least `HUGE_PAGE`
+/// are aligned to a huge page and the kernel is advised to back them by huge pages (Linux only).
+/// Throws an `std::bad_alloc` if the allocation fails.
+/// \param bytes The size of the block.
+/// \return The block, to be freed by `release`.
+void* allocate(size_t bytes);
+
+/// Frees a block returned by `allocate`.
+/// \param data The block, can be null.
+void release(void* data) noexcept;
+
+
+/// Standard allocator returning `allocate` blocks, for containers read by the kernels.
+template<typename T>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    AlignedAllocator() noexcept = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(Memory::allocate(count * sizeof(T)));
+    }
+
+    void deallocate(T* data, size_t) noexcept {
+        Memory::release(data);
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U>&) const noexcept { return true; }
+
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U>&) const noexcept { return false; }
+};
+
+/// A vector starting at a cache line.
+template<typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+
+/// Bump-pointer allocator for the scratch buffers of a job, such as the per-tile buffers of the window sweep.
+/// The long-lived image planes use `AlignedVector` instead. Allocations are carved from a chunk, and `reset`
+/// makes the whole chunk reusable at once, so a job repeated on the same arena allocates only the first time.
+/// The buffers are not constructed nor destructed, only trivial types should be stored.
+class Arena {
+public:
+                Arena       () = default;
+                Arena       (const Arena&) = delete;
+    Arena&      operator=   (const Arena&) = delete;
+                ~Arena      ();
+
+    /// Allocates an array, aligned to `CACHE_LINE`. Valid until the next `reset`.
+    /// \tparam T The element type.
+    /// \param count The number of elements.
+    /// \return The uninitialized array.
+    template<typename T>
+    T* allocate(size_t count) {
+        return static_cast<T*>(allocateBytes(count * sizeof(T)));
+    }
+
+    /// Frees every allocation. If the last job did not fit in a single chunk, it is replaced by one that fits
+    /// everything the job allocated.
+    void        reset       ();
+
+private:
+    void*       allocateBytes(size_t bytes);
+
+    std::vector<void*>  m_chunks;
+    size_t              m_capacity = 0;     ///< The size of the last chunk.
+    size_t              m_used = 0;         ///< The bytes used in the last chunk.
+    size_t              m_total = 0;        ///< The bytes allocated since the last reset.
+};
+
+
+/// Gets the arena of the opt-in planes of the running job, such as `WindowCache`. Not thread safe, the planes
+/// are built by the main thread. `main` resets it after every job, once the planes of the job are destroyed.
+Arena& jobArena();
+
+}   // namespace Memory
+
+
+#endif //DISPARITY_CPU_MEMORY_HPP
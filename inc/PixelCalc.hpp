@@ -4,23 +4,73 @@
 
 #include <memory>
 #include "Pixels.hpp"
-#include "Float8.hpp"
+#include "WindowCache.hpp"
+#include "IntegralImage.hpp"
+#include "Census.hpp"
 
 
 // TODO docs
 class PixelCalc {
 public:
-    static PixelCalc            calculatePixelCalc  (const Pixelsf& pixels, int window);
+    /// The planes `calculatePixelCalc` can build, combined with `|`. Only the built planes can be accessed.
+    enum Planes : unsigned {
+        StatisticsPlanes    = 1u << 0,  ///< `means`, `invStds` and `centered`.
+        PaddedPlane         = 1u << 1,  ///< `padded`.
+        CensusPlanes        = 1u << 2,  ///< `census`.
+        WindowCachePlane    = 1u << 3,  ///< `windowCache` of `centered`, `window * window` planes of the image size.
+    };
+
+    /// Calculates the window statistics of an image.
+    /// \param pixels The image. Must outlive the returned object.
+    /// \param window Window size.
+    /// \param apron The replicated border of the planes, see `Pixels::getRow`.
+    /// \param planes The planes to build, a combination of `Planes`. The window cache is opt-in, it is allocated
+    /// from `Memory::jobArena`, and needs `StatisticsPlanes`, otherwise an `std::exception` is thrown.
+    /// \return The statistics.
+    static PixelCalc            calculatePixelCalc  (const Pixelsf& pixels, int window, int apron = 0,
+                                                     unsigned planes = StatisticsPlanes);
     const Pixelsf&              pixels              () const { return m_pixels; }
+    int                         window              () const { return m_window; }
+    int                         apron               () const { return m_apron; }
     const Pixelsf&              means               () const { return *m_means; }
-    const std::vector<Float8>&  getWindowData       (int cx, int cy) const;
+    const Pixelsf&              invStds             () const { return *m_invStds; }
+    const Pixelsf&              centered            () const { return *m_centered; }
+
+    /// Gets the pixel values extended by the apron.
+    const Pixelsf&              padded              () const { return *m_padded; }
+
+    /// Gets the census descriptors extended by the apron, see `Census::transform`.
+    const Census::Descriptors&  census              () const { return m_census; }
+
+    /// Gets the windows of the centered values of every pixel, extended by the apron, see `WindowCache`.
+    const WindowCache&          windowCache         () const { return *m_windowCache; }
+
+    /// Returns the mean of the pixel values in the window around a pixel in O(1) time. Needs `StatisticsPlanes`.
+    /// \param cx The center column of the window.
+    /// \param cy The center row of the window.
+    /// \return The window mean.
+    float                       windowMean          (int cx, int cy) const;
+
+    /// Returns the variance of the pixel values in the window around a pixel in O(1) time. Needs `StatisticsPlanes`.
+    /// \param cx The center column of the window.
+    /// \param cy The center row of the window.
+    /// \return The window variance.
+    float                       windowVariance      (int cx, int cy) const;
 
 private:
-    explicit                    PixelCalc           (const Pixelsf& pixels) noexcept;
+                                PixelCalc           (const Pixelsf& pixels, int window, int apron);
 
     const Pixelsf&                      m_pixels;
+    const int                           m_window;
+    const int                           m_apron;
+    std::unique_ptr<IntegralImage>      m_sums;
+    std::unique_ptr<IntegralImage>      m_squareSums;
     std::unique_ptr<Pixelsf>            m_means;
-    std::vector<std::vector<Float8>>    m_windowCache;
+    std::unique_ptr<Pixelsf>            m_invStds;
+    std::unique_ptr<Pixelsf>            m_centered;
+    std::unique_ptr<Pixelsf>            m_padded;
+    Census::Descriptors                 m_census;
+    std::unique_ptr<WindowCache>        m_windowCache;
 };
 
 
@@ -7,10 +7,17 @@
 /// Contains basic PNG image loading and saving functions. Curretly implemented using lodePng.
 namespace PixelUtils {
 
-/// Loads a PNG file from disk and resizes it to 1/4 of its original dimensions.
+/// Loads a PNG file from disk and resizes it to 1/`factor` of its original dimensions.
 /// \param filename The path of the image file to read.
+/// \param factor Subsampling factor, 1 keeps the full resolution.
 /// \return 0-255 valued floating point array of the image.
-Pixelsf loadGrey    (const char* filename);
+Pixelsf loadGrey    (const char* filename, int factor);
+
+/// Loads a PNG file from disk and resizes it to 1/`factor` of its original dimensions.
+/// \param filename The path of the image file to read.
+/// \param factor Subsampling factor, 1 keeps the full resolution.
+/// \return 8-bit array of the image.
+Pixelsb loadGrey8   (const char* filename, int factor);
 
 /// Saves a Pixel array to disk in PNG format.
 /// \param pixels 0-255 valued pixel data to save.
@@ -4,11 +4,12 @@
 
 #include <vector>
 #include <functional>
-#include <thread>
-#include <future>
 #include <algorithm>
 #include <iostream>
-#include "CliOptions.hpp"
+#include <limits>
+#include <utility>
+#include "Workers.hpp"
+#include "Memory.hpp"
 
 
 /// Provides helper functionality to linearly stored pixel arrays.
@@ -21,13 +22,79 @@ public:
     /// \param width Width of the pixel image.
     /// \param height Height of the pixel image.
     Pixels(std::vector<T>&& data, unsigned width, unsigned height) noexcept :
-            m_data      (data),
+            m_data      (std::move(data)),
             m_width     (width),
-            m_height    (height)
+            m_height    (height),
+            m_stride    (static_cast<int>(width))
     {
         static_assert(std::is_arithmetic<T>::value, "arithmetic type required");
     }
 
+    /// Constructs a `Pixels` object from given data, extended by an apron of `apron` rows and columns on every
+    /// side. The apron repeats the edge values, so within it `getUnclamped` and `getRow` give the same values
+    /// as `get`, without any branches. With an apron only the extended copy is kept, column 0 of every of its
+    /// rows starts at a cache line, see `Memory::CACHE_LINE`.
+    /// \param data Source data array.
+    /// \param width Width of the pixel image.
+    /// \param height Height of the pixel image.
+    /// \param apron The number of replicated rows and columns on every side.
+    Pixels(std::vector<T>&& data, unsigned width, unsigned height, int apron) :
+            m_data      (apron > 0 ? std::vector<T>() : std::move(data)),
+            m_width     (width),
+            m_height    (height),
+            m_apron     (apron),
+            m_offset    (apron > 0 ? roundToLine(apron) : 0),
+            m_stride    (apron > 0 ? roundToLine(m_offset + static_cast<int>(width) + apron)
+                                   : static_cast<int>(width)),
+            m_padded    (apron > 0 ? createApron(data) : Memory::AlignedVector<T>())
+    {
+        static_assert(std::is_arithmetic<T>::value, "arithmetic type required");
+    }
+
+    /// Constructs a `Pixels` object from data written straight into the extended copy, so it is not copied again.
+    /// Pixel `(row, col)` is at `paddedOrigin(width, apron) + row * paddedStride(width, apron) + col`, only the
+    /// pixels of the image have to be set, the apron is filled here. The copy is kept even without an apron.
+    /// Throws an `std::exception` if `padded` does not have `paddedSize(width, height, apron)` elements.
+    /// \param width Width of the pixel image.
+    /// \param height Height of the pixel image.
+    /// \param apron The number of replicated rows and columns on every side.
+    /// \param padded The extended copy, see `getRow`.
+    Pixels(unsigned width, unsigned height, int apron, Memory::AlignedVector<T>&& padded) :
+            m_width     (width),
+            m_height    (height),
+            m_apron     (apron),
+            m_offset    (roundToLine(apron)),
+            m_stride    (paddedStride(width, apron)),
+            m_padded    (fillApron(std::move(padded)))
+    {
+        static_assert(std::is_arithmetic<T>::value, "arithmetic type required");
+    }
+
+    /// Gets the distance between two rows of the extended copy of an image, see `getStride`.
+    /// \param width Width of the pixel image.
+    /// \param apron The number of replicated rows and columns on every side.
+    /// \return The row stride in elements, `width + 2 * apron` rounded to whole cache lines.
+    static int paddedStride(unsigned width, int apron) noexcept {
+        return roundToLine(roundToLine(apron) + static_cast<int>(width) + apron);
+    }
+
+    /// Gets the position of row 0, column 0 in the extended copy of an image.
+    /// \param width Width of the pixel image.
+    /// \param apron The number of replicated rows and columns on every side.
+    /// \return The index of the pixel, at the start of a cache line.
+    static size_t paddedOrigin(unsigned width, int apron) noexcept {
+        return static_cast<size_t>(apron) * paddedStride(width, apron) + roundToLine(apron);
+    }
+
+    /// Gets the number of elements of the extended copy of an image.
+    /// \param width Width of the pixel image.
+    /// \param height Height of the pixel image.
+    /// \param apron The number of replicated rows and columns on every side.
+    /// \return The size of the copy.
+    static size_t paddedSize(unsigned width, unsigned height, int apron) noexcept {
+        return static_cast<size_t>(paddedStride(width, apron)) * (height + 2 * apron);
+    }
+
     /// Gets the width of the pixel image.
     /// \return The width of the pixel image.
     unsigned getWidth() const noexcept { return m_width; }
@@ -37,9 +104,34 @@ public:
     unsigned getHeight() const noexcept { return m_height; }
 
     /// Gets the underlying data container.
-    /// \return The data array containing the pixel information.
+    /// \return The data array containing the pixel information, empty if there is an extended copy, see `getRow`.
     const std::vector<T>& getData() const noexcept { return m_data; }
 
+    /// Gets the size of the replicated border around the image.
+    /// \return The number of apron rows and columns on every side, 0 if there is no apron.
+    int getApron() const noexcept { return m_apron; }
+
+    /// Gets the distance between two rows returned by `getRow`.
+    /// \return The row stride in elements, `getWidth()` without an extended copy, otherwise at least
+    ///         `getWidth() + 2 * getApron()` rounded to whole cache lines.
+    int getStride() const noexcept { return m_stride; }
+
+    /// Gets a row of the data extended by the apron.
+    /// \param row The row to get, in the range `[-getApron(), getHeight() + getApron())`.
+    /// \return Pointer to column 0 of the row. Columns in `[-getApron(), getWidth() + getApron())` can be read.
+    const T* getRow(int row) const noexcept {
+        const T* data = m_padded.empty() ? m_data.data() : m_padded.data();
+        return data + (row + m_apron) * m_stride + m_offset;
+    }
+
+    /// Same as `get`, but without clamping. The position must be inside the image or its apron.
+    /// \param row The row in the matrix to get.
+    /// \param col The column in the matrix to get.
+    /// \return The data value specified by `row` and `col`.
+    T getUnclamped(int row, int col) const noexcept {
+        return getRow(row)[col];
+    }
+
     /// Maps the pixel data to a 2d matrix, and returns the value at a particular position.
     /// Overflow is treated by returning the edge values.
     /// \param row The row in the matrix to get.
@@ -56,7 +148,7 @@ public:
         } else if ((unsigned)col >= m_width) {
             col = m_width - 1;
         }
-        return m_data[m_width * row + col];
+        return m_padded.empty() ? m_data[m_width * row + col] : getUnclamped(row, col);
     }
 
     /// Enumerates the data values in a window around a specified row and column.
@@ -90,6 +182,21 @@ public:
         return windowData;
     }
 
+    /// Copies the data into a new array, in which every row is extended by `border` columns on both sides.
+    /// The extra columns repeat the edge values, same as `get`.
+    /// \param border The number of columns to add to both sides of a row.
+    /// \return The padded data, with `getWidth() + 2 * border` elements per row.
+    std::vector<T> getPaddedRows(int border) const {
+        const int stride = m_width + 2 * border;
+        std::vector<T> padded(static_cast<size_t>(stride) * m_height);
+        for (int row = 0; row < m_height; ++row) {
+            for (int col = -border; col < static_cast<int>(m_width) + border; ++col) {
+                padded[row * stride + col + border] = get(row, col);
+            }
+        }
+        return padded;
+    }
+
     /// Enumerates two `Pixels` instances against each other in a multithreaded way.
     /// Throws an `std::exception` if the two input `Pixels` is different in size.
     /// \tparam U The type of the output `Pixels` object.
@@ -103,47 +210,123 @@ public:
         if (leftPixels.getHeight() != rightPixels.getHeight() || leftPixels.getWidth() != rightPixels.getWidth()) {
             throw std::exception();
         }
-        const unsigned threads = static_cast<unsigned>(CliOptions::getThreads());
         const int width = leftPixels.getWidth();
         const int height = leftPixels.getHeight();
-        const int rows = height / threads;
-
-        std::vector<std::future<std::vector<U>>> futures;
-        for (int i = 0; i < threads; ++i) {
-            futures.push_back(std::async(std::launch::async, [width, height, threads, rows, i, &fun](){
-                std::vector<U> subRes(width*height/threads);
-                unsigned index = 0;
-                for (int row = i*rows; row < (i+1)*rows; ++row) {
-                    for (int col = 0; col < width; ++col) {
-                        subRes[index++] = fun(row, col);
-                    }
-                }
-                return subRes;
-            }));
-        }
 
-        std::vector<U> result;
-        for (auto& future : futures) {
-            auto subRes = future.get();
-            result.insert(result.end(), subRes.begin(), subRes.end());
-        }
+        std::vector<U> result(static_cast<size_t>(width) * height);
+        Workers::forEachBand(height, [width, &result, &fun](int begin, int end) {
+            for (int row = begin; row < end; ++row) {
+                for (int col = 0; col < width; ++col) {
+                    result[row * width + col] = fun(row, col);
+                }
+            }
+        });
 
         return Pixels<U>(std::move(result), leftPixels.getWidth(), leftPixels.getHeight());
     }
 
 private:
+    /// Rounds a number of elements up to whole cache lines.
+    static int roundToLine(int count) {
+        const int line = static_cast<int>(std::max<size_t>(Memory::CACHE_LINE / sizeof(T), 1));
+        return (count + line - 1) / line * line;
+    }
+
+    Memory::AlignedVector<T> createApron(const std::vector<T>& data) const {
+        Memory::AlignedVector<T> padded(static_cast<size_t>(m_stride) * (m_height + 2 * m_apron));
+        // the rows are copied whole, the columns around them repeat the edge values up to the stride
+        Workers::forEachBand(m_height + 2 * m_apron, [&](int begin, int end) {
+            for (int row = begin; row < end; ++row) {
+                const int source = std::min(std::max(row - m_apron, 0), static_cast<int>(m_height) - 1);
+                const auto first = data.begin() + static_cast<size_t>(source) * m_width;
+                const auto target = padded.begin() + static_cast<size_t>(row) * m_stride;
+                std::fill(target, target + m_offset, *first);
+                std::copy(first, first + m_width, target + m_offset);
+                std::fill(target + m_offset + m_width, target + m_stride, *(first + m_width - 1));
+            }
+        });
+        return padded;
+    }
+
+    Memory::AlignedVector<T> fillApron(Memory::AlignedVector<T>&& padded) const {
+        if (padded.size() != paddedSize(m_width, m_height, m_apron)) {
+            throw std::exception();
+        }
+        // the columns around the rows repeat the edge values up to the stride
+        Workers::forEachBand(m_height, [&](int begin, int end) {
+            for (int row = begin; row < end; ++row) {
+                const auto target = padded.begin() + static_cast<size_t>(row + m_apron) * m_stride;
+                std::fill(target, target + m_offset, *(target + m_offset));
+                std::fill(target + m_offset + m_width, target + m_stride, *(target + m_offset + m_width - 1));
+            }
+        });
+        // the apron rows repeat the first and the last row
+        const auto first = padded.begin() + static_cast<size_t>(m_apron) * m_stride;
+        const auto last = padded.begin() + static_cast<size_t>(m_apron + m_height - 1) * m_stride;
+        for (int row = 0; row < m_apron; ++row) {
+            const auto below = padded.begin() + static_cast<size_t>(m_apron + m_height + row) * m_stride;
+            std::copy(first, first + m_stride, padded.begin() + static_cast<size_t>(row) * m_stride);
+            std::copy(last, last + m_stride, below);
+        }
+        return std::move(padded);
+    }
+
     const std::vector<T> m_data;
     const unsigned m_width;
     const unsigned m_height;
+    const int m_apron = 0;
+    const int m_offset = 0;     ///< The columns before column 0 in a row of the copy.
+    const int m_stride;
+    const Memory::AlignedVector<T> m_padded;
 };
 
 using Pixelsi = Pixels<int>;
 using Pixelsf = Pixels<float>;
+using Pixelsb = Pixels<unsigned char>;
+
+
+/// The depth maps of a stereo pair, matched from both sides.
+struct DepthMaps {
+    Pixelsi left;   ///< The disparities of the left image pixels.
+    Pixelsi right;  ///< The disparities of the right image pixels, as if the images were swapped.
+};
+
+
+/// A depth map matched from a single side, with the confidence of every disparity.
+struct ConfidentDepthMap {
+    Pixelsi disparities;    ///< The disparities of the left image pixels.
+    Pixelsf confidence;     ///< How much the best score stands out of the others, in `[0, 1]`.
+};
 
 
 #ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+/// Builds a stereo pair for the tests. The right image is hashed noise in `[0, 255]`, the left one is the right
+/// one moved by `shift` columns, its first columns repeat the edge. Every disparity is `shift`.
+/// \param width Width of the images.
+/// \param height Height of the images.
+/// \param shift The disparity of the pair.
+/// \param flat The right image columns from this one on are constant, so no disparity stands out there.
+/// \return The left and the right image.
+template<typename T = float>
+std::pair<Pixels<T>, Pixels<T>> shiftedPair(int width, int height, int shift,
+                                            int flat = std::numeric_limits<int>::max()) {
+    std::vector<T> leftData(static_cast<size_t>(width) * height), rightData(static_cast<size_t>(width) * height);
+    for (int row = 0; row < height; ++row) {
+        for (int col = 0; col < width; ++col) {
+            unsigned hash = static_cast<unsigned>(col) * 73856093u ^ static_cast<unsigned>(row) * 19349663u;
+            hash = (hash ^ (hash >> 13)) * 0x5bd1e995u;
+            rightData[row * width + col] = col < flat ? static_cast<T>(hash >> 24) : static_cast<T>(100);
+        }
+        for (int col = 0; col < width; ++col) {
+            leftData[row * width + col] = rightData[row * width + std::max(col - shift, 0)];
+        }
+    }
+    return { Pixels<T>(std::move(leftData), width, height), Pixels<T>(std::move(rightData), width, height) };
+}
+
+
 TEST_CASE("testing Pixels accessor") {
-    Pixels pw ({1, 2, 3, 4, 5, 6, 7, 8, 9}, 3, 3);
+    Pixelsi pw ({1, 2, 3, 4, 5, 6, 7, 8, 9}, 3, 3);
     CHECK_EQ(pw.get(0, 0), 1);
     CHECK_EQ(pw.get(0, -1), 1);
     CHECK_EQ(pw.get(-1, 0), 1);
@@ -151,6 +334,47 @@ TEST_CASE("testing Pixels accessor") {
     CHECK_EQ(pw.get(1, 3), 6);
     CHECK_EQ(pw.get(3, 3), 9);
 }
+
+TEST_CASE("testing Pixels apron") {
+    Pixelsi pw ({1, 2, 3, 4, 5, 6, 7, 8, 9}, 3, 3, 2);
+    CHECK(pw.getData().empty());
+    CHECK_EQ(pw.get(1, -1), 4);
+    CHECK_EQ(pw.get(3, 3), 9);
+    for (int row = -2; row < 5; ++row) {
+        for (int col = -2; col < 5; ++col) {
+            CHECK_EQ(pw.getUnclamped(row, col), pw.get(row, col));
+        }
+    }
+    CHECK_EQ(pw.getRow(1)[1], 5);
+    CHECK_EQ(pw.getRow(-1) - pw.getRow(-2), pw.getStride());
+    for (int row = -2; row < 5; ++row) {
+        CHECK_EQ(reinterpret_cast<uintptr_t>(pw.getRow(row)) % Memory::CACHE_LINE, 0);
+    }
+}
+
+TEST_CASE("testing Pixels written straight into the apron copy") {
+    const Pixelsi copied ({1, 2, 3, 4, 5, 6, 7, 8, 9}, 3, 3, 2);
+    for (int apron : { 0, 2 }) {
+        const int stride = Pixelsi::paddedStride(3, apron);
+        Memory::AlignedVector<int> padded(Pixelsi::paddedSize(3, 3, apron));
+        for (int row = 0; row < 3; ++row) {
+            for (int col = 0; col < 3; ++col) {
+                padded[Pixelsi::paddedOrigin(3, apron) + row * stride + col] = row * 3 + col + 1;
+            }
+        }
+        const Pixelsi pw (3, 3, apron, std::move(padded));
+        CHECK(pw.getData().empty());
+        CHECK_EQ(pw.getStride(), stride);
+        CHECK_EQ(reinterpret_cast<uintptr_t>(pw.getRow(0)) % Memory::CACHE_LINE, 0);
+        for (int row = -apron; row < 3 + apron; ++row) {
+            for (int col = -apron; col < 3 + apron; ++col) {
+                CHECK_EQ(pw.getUnclamped(row, col), copied.get(row, col));
+            }
+        }
+        CHECK_EQ(pw.get(3, 3), 9);
+    }
+    CHECK_THROWS(Pixelsi(3, 3, 2, Memory::AlignedVector<int>(9)));
+}
 #endif
 
 
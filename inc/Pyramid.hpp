@@ -0,0 +1,44 @@
+#ifndef DISPARITY_CPU_PYRAMID_HPP
+#define DISPARITY_CPU_PYRAMID_HPP
+
+
+#include <functional>
+#include "Pixels.hpp"
+#include "Kernels.hpp"
+
+
+/// Coarse-to-fine disparity search. The full disparity range is only searched on the coarsest level
+/// of an image pyramid, every finer level searches a narrow band around the upsampled disparities of the
+/// level above it.
+namespace Pyramid {
+
+/// Searches the full disparity range of a level. Receives the left and right images of the level
+/// and the disparity range `[minD, maxD)` to search, returns the disparity map.
+using FullSearch = std::function<Pixelsi(const Pixelsf&, const Pixelsf&, int, int)>;
+
+/// Halves an image in both dimensions by averaging 2x2 blocks.
+/// \param pixels The image to shrink.
+/// \return The image of the next pyramid level.
+Pixelsf downsample(const Pixelsf& pixels);
+
+/// Finds the best disparity for every pixel of the left image.
+/// \param leftPixels Left image data.
+/// \param rightPixels Right image data.
+/// \param window Window size, the same on every level.
+/// \param minD The first disparity to search on the finest level, halved on every coarser level.
+/// \param maxD The end of the searched disparity range on the finest level, halved on every coarser level.
+/// \param levels The number of pyramid levels, 1 runs `fullSearch` on the input images only.
+///               Levels smaller than the window are not built.
+/// \param band The number of disparities searched on both sides of the upsampled disparities.
+/// \param invertD Should be true, if the order of left and right pixel data is reversed.
+/// \param fullSearch Runs the search on the coarsest level.
+/// \param kernels The kernel variant refining the finer levels.
+/// \return The disparity map.
+Pixelsi calcDepthMap(const Pixelsf& leftPixels, const Pixelsf& rightPixels, int window, int minD, int maxD,
+                     int levels, int band, bool invertD, const FullSearch& fullSearch,
+                     const Kernels::Table& kernels = Kernels::active());
+
+}   // namespace Pyramid
+
+
+#endif //DISPARITY_CPU_PYRAMID_HPP
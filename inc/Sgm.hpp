@@ -0,0 +1,43 @@
+#ifndef DISPARITY_CPU_SGM_HPP
+#define DISPARITY_CPU_SGM_HPP
+
+
+#include "CostVolume.hpp"
+#include "Kernels.hpp"
+
+
+/// Semi-global matching. Smooths the matching costs of a cost volume along straight paths through the image,
+/// penalizing disparity changes between neighbouring pixels, then takes the disparities with the lowest sum
+/// of the path costs.
+namespace Sgm {
+
+/// The penalties of the disparity changes along a path, in units of the matching cost `1 - ZNCC`.
+struct Penalties {
+    float p1;   ///< Penalty of a change by 1.
+    float p2;   ///< Penalty of larger changes.
+};
+
+/// Aggregates the costs of a volume, and finds the best disparity of every pixel of both images.
+/// The horizontal paths run in parallel over the rows, the others are split between the threads, each
+/// group of paths summing into its own buffer of the size of the volume.
+/// Throws an `std::exception` if the volume is not stored as `Float32` with `DisparityInner` layout,
+/// or `paths` is not 4 or 8.
+/// \param volume The ZNCC scores.
+/// \param paths The number of path directions, 4 (horizontal and vertical) or 8 (also diagonal).
+/// \param penalties The smoothness penalties.
+/// \param kernels The kernel variant to run.
+/// \return The disparity maps of both images. The right map takes the lowest sums along the diagonals
+///         of the aggregated volume, skipping the pairs with left pixels outside the image.
+DepthMaps calcDepthMaps(const CostVolume& volume, int paths, const Penalties& penalties,
+                        const Kernels::Table& kernels = Kernels::active());
+
+/// Calculates the memory `calcDepthMaps` allocates on top of the volume.
+/// \param volume The volume to aggregate.
+/// \param paths The number of path directions.
+/// \return The size of the path cost sums and the path buffers in bytes.
+size_t bytesRequired(const CostVolume& volume, int paths);
+
+}   // namespace Sgm
+
+
+#endif //DISPARITY_CPU_SGM_HPP
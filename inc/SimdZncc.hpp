@@ -0,0 +1,76 @@
+#ifndef DISPARITY_CPU_SIMDZNCC_HPP
+#define DISPARITY_CPU_SIMDZNCC_HPP
+
+
+#include "PixelCalc.hpp"
+#include "Kernels.hpp"
+
+
+/// Vectorized ZNCC matching engines. They run the kernels of the variant returned by `Kernels::active()`.
+namespace SimdZncc {
+
+/// Finds the best disparity for every pixel of the left image, scoring 8 consecutive disparities
+/// of a pixel per instruction. The running maximum is kept in vector registers.
+/// Throws an `std::exception` if the aprons of the planes are smaller than required.
+/// \param leftCalc Precomputed data of the left image, with an apron of at least `window / 2`.
+/// \param rightCalc Precomputed data of the right image, with an apron of at least `window / 2 + maxD`.
+/// \param window Window size.
+/// \param minD The first disparity to search.
+/// \param maxD The end of the searched disparity range, exclusive.
+/// \param invertD Should be true, if the order of left and right pixel data is reversed.
+/// \param kernels The kernel variant to run.
+/// \return The disparity map.
+Pixelsi calcDepthMapDisparityLanes(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD,
+                                   int maxD, bool invertD, const Kernels::Table& kernels = Kernels::active());
+
+/// Finds the best disparity for every pixel of the left image, scoring the same disparity
+/// of 8 horizontally adjacent pixels per instruction. The windows are read with contiguous loads.
+/// Throws an `std::exception` if the aprons of the planes are smaller than required.
+/// \param leftCalc Precomputed data of the left image, with an apron of at least `window / 2`.
+/// \param rightCalc Precomputed data of the right image, with an apron of at least `window / 2 + maxD`.
+/// \param window Window size.
+/// \param minD The first disparity to search.
+/// \param maxD The end of the searched disparity range, exclusive.
+/// \param invertD Should be true, if the order of left and right pixel data is reversed.
+/// \param kernels The kernel variant to run.
+/// \return The disparity map.
+Pixelsi calcDepthMapRowLanes(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD,
+                             int maxD, bool invertD, const Kernels::Table& kernels = Kernels::active());
+
+/// Same as `calcDepthMapRowLanes`, but reads the windows from the window caches of the images, see `WindowCache`.
+/// The products are summed in the same order, so the disparity map is the same.
+/// Throws an `std::exception` if the aprons of the planes are smaller than required, or the caches are built
+/// for another window size.
+/// \param leftCalc Precomputed data of the left image, with an apron of at least `window / 2` and
+/// `WindowCachePlane`.
+/// \param rightCalc Precomputed data of the right image, with an apron of at least `window / 2 + maxD` and
+/// `WindowCachePlane`.
+/// \param window Window size.
+/// \param minD The first disparity to search.
+/// \param maxD The end of the searched disparity range, exclusive.
+/// \param invertD Should be true, if the order of left and right pixel data is reversed.
+/// \param kernels The kernel variant to run.
+/// \return The disparity map.
+Pixelsi calcDepthMapCachedRowLanes(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD,
+                                   int maxD, bool invertD, const Kernels::Table& kernels = Kernels::active());
+
+/// Finds the best disparity for every pixel of both images with the row lanes kernels, computing every
+/// correlation only once. The score of left pixel `x` at disparity `d` is the score of right pixel `x - d`
+/// at `d` in the opposite direction, so the right disparities are the maximums along the diagonals of the
+/// scores the left search computes. The left map is the same as the one of `calcDepthMapRowLanes`, the right
+/// map only differs from the inverted search where that pairs the pixel with a column outside the left image.
+/// Throws an `std::exception` if the aprons of the planes are smaller than required.
+/// \param leftCalc Precomputed data of the left image, with an apron of at least `window / 2`.
+/// \param rightCalc Precomputed data of the right image, with an apron of at least `window / 2 + maxD`.
+/// \param window Window size.
+/// \param minD The first disparity to search.
+/// \param maxD The end of the searched disparity range, exclusive.
+/// \param kernels The kernel variant to run.
+/// \return The disparity maps of both images.
+DepthMaps calcDepthMapsRowLanes(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD,
+                                int maxD, const Kernels::Table& kernels = Kernels::active());
+
+}   // namespace SimdZncc
+
+
+#endif //DISPARITY_CPU_SIMDZNCC_HPP
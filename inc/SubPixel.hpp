@@ -0,0 +1,54 @@
+#ifndef DISPARITY_CPU_SUBPIXEL_HPP
+#define DISPARITY_CPU_SUBPIXEL_HPP
+
+
+#include <string>
+#include "PixelCalc.hpp"
+#include "MatchingCost.hpp"
+
+
+/// Sub-pixel disparity refinement. Fits a curve to the scores of the best disparity of a pixel and its two
+/// neighbours, and moves the disparity to the peak of the curve, so a map at a lower resolution keeps the
+/// depth precision of a higher one.
+namespace SubPixel {
+
+/// The curves selectable with the `--subpixel` option.
+enum class Method {
+    None,           ///< No refinement, the disparities stay integers.
+    Parabola,       ///< A parabola through the three scores, suits costs quadratic in the shift like SSD.
+    Equiangular,    ///< Two lines of opposite slopes, suits costs linear in the shift like SAD.
+};
+
+/// Selects a method by the name given in the `--subpixel` option.
+/// Throws an `std::exception` if the name is unknown.
+/// \param name One of `none`, `parabola` and `equiangular`.
+/// \return The method.
+Method parse(const std::string& name);
+
+/// Calculates the offset of the peak of the curve through the scores of three consecutive disparities.
+/// \param method The curve.
+/// \param below The score of the disparity below the best one.
+/// \param best The score of the best disparity, not less than the other two.
+/// \param above The score of the disparity above the best one.
+/// \return The offset from the best disparity in `[-0.5, 0.5]`, 0 if the scores are flat.
+float offset(Method method, float below, float best, float above);
+
+/// Refines a depth map by the scores of the neighbouring disparities of every pixel. The disparities at the
+/// ends of the searched range, with a single searched neighbour, are kept.
+/// Throws an `std::exception` if the aprons of the planes are smaller than required.
+/// \param leftCalc Precomputed data of the left image, with an apron of at least `window / 2`.
+/// \param rightCalc Precomputed data of the right image, with an apron of at least `window / 2 + maxD`.
+/// \param depthMap The disparities found in `[minD, maxD)`.
+/// \param minD The first searched disparity.
+/// \param maxD The end of the searched disparity range, exclusive.
+/// \param invertD Should be true, if the order of left and right pixel data is reversed.
+/// \param cost The matching cost, both images must have its planes.
+/// \param method The curve.
+/// \return The refined disparity map.
+Pixelsf refine(const PixelCalc& leftCalc, const PixelCalc& rightCalc, const Pixelsi& depthMap, int minD, int maxD,
+               bool invertD, MatchingCost::Kind cost, Method method);
+
+}   // namespace SubPixel
+
+
+#endif //DISPARITY_CPU_SUBPIXEL_HPP
@@ -0,0 +1,63 @@
+#ifndef DISPARITY_CPU_WINDOWCACHE_HPP
+#define DISPARITY_CPU_WINDOWCACHE_HPP
+
+
+#include "Pixels.hpp"
+#include "Memory.hpp"
+
+
+/// The windows of every pixel of an image in a structure-of-arrays layout: plane `k` holds element `k` of the
+/// window of every pixel, the elements counted in row-major order like `Pixels::getWindowData`. The planes are
+/// carved from a `Memory::Arena` in a single block, the rows of a plane are extended by `apron` columns on both
+/// sides, and column 0 of every row starts at an `ALIGNMENT` boundary, so the vectors of adjacent pixels of a
+/// plane are read by aligned loads.
+class WindowCache {
+public:
+    /// The alignment of column 0 of the plane rows in bytes, that of the widest vector load.
+    static constexpr size_t ALIGNMENT = Memory::CACHE_LINE;
+
+    /// Copies the windows of every pixel and of the apron columns. Positions outside the image repeat the edge
+    /// values, the same as `Pixels::get`.
+    /// \param pixels The image.
+    /// \param window Window size.
+    /// \param apron The number of columns added to both sides of the rows.
+    /// \param arena The arena of the planes, which must not be reset while the cache is used.
+                                WindowCache         (const Pixelsf& pixels, int window, int apron,
+                                                     Memory::Arena& arena);
+
+    int                         window              () const { return m_window; }
+    int                         apron               () const { return m_apron; }
+
+    /// Gets the number of floats between the starts of two rows of a plane, a multiple of `ALIGNMENT`.
+    int                         stride              () const { return m_stride; }
+
+    /// Gets the number of floats between the starts of two planes.
+    size_t                      planeSize           () const { return m_planeSize; }
+
+    /// Gets column 0 of the first row of a plane.
+    /// \param element The index of the window element, in `[0, window * window)`.
+    /// \return The data of the plane, the columns in `[-apron(), width + apron())` can be read.
+    const float*                plane               (int element) const {
+        return m_data + element * m_planeSize + m_offset;
+    }
+
+    /// Gets an element of the window of a pixel.
+    /// \param element The index of the window element, in `[0, window * window)`.
+    /// \param row The row of the pixel.
+    /// \param col The column of the pixel, in `[-apron(), width + apron())`.
+    /// \return The value of the window element.
+    float                       get                 (int element, int row, int col) const {
+        return plane(element)[row * m_stride + col];
+    }
+
+private:
+    const int                   m_window;
+    const int                   m_apron;
+    const int                   m_offset;       ///< The floats before column 0 in a row.
+    const int                   m_stride;
+    const size_t                m_planeSize;
+    float* const                m_data;
+};
+
+
+#endif //DISPARITY_CPU_WINDOWCACHE_HPP
@@ -0,0 +1,63 @@
+#ifndef DISPARITY_CPU_WINDOWSWEEP_HPP
+#define DISPARITY_CPU_WINDOWSWEEP_HPP
+
+
+#include "PixelCalc.hpp"
+#include "MatchingCost.hpp"
+
+
+/// Window matching engine sweeping the disparities in the outer loop. A band of rows is scored at a single
+/// disparity before moving to the next one, keeping the best score and disparity of every pixel of the band
+/// in arrays. The cost terms of the window rows are computed once per image row and disparity, into a ring
+/// of `window` rows, so the working set of a disparity stays in the cache.
+namespace WindowSweep {
+
+/// Chooses the rows of a tile, so the working set of sweeping a tile through the disparities fits in the cache:
+/// the best scores of the tile, and the plane rows its windows read at every disparity.
+/// \param width The number of pixels in a row.
+/// \param height The number of rows, the most a tile can have.
+/// \param window Window size.
+/// \param maxD The end of the searched disparity range, exclusive.
+/// \param cost The matching cost, which determines the planes read.
+/// \param cacheBytes The size of the cache to fit in, see `CpuFeatures::l2CacheSize`.
+/// \return The rows of a tile, at least `window` unless the image is shorter.
+int tileRows(int width, int height, int window, int maxD, MatchingCost::Kind cost, size_t cacheBytes);
+
+/// Finds the best disparity for every pixel of the left image. Sums the terms of every window in the same
+/// order as evaluating the windows one by one, so the results are the same.
+/// Throws an `std::exception` if the aprons of the planes are smaller than required.
+/// \param leftCalc Precomputed data of the left image, with an apron of at least `window / 2`.
+/// \param rightCalc Precomputed data of the right image, with an apron of at least `window / 2 + maxD`.
+/// \param window Window size.
+/// \param minD The first disparity to search.
+/// \param maxD The end of the searched disparity range, exclusive.
+/// \param invertD Should be true, if the order of left and right pixel data is reversed.
+/// \param cost The matching cost, both images must have its planes.
+/// \param tile If positive, the rows are dealt out to the threads in tiles of this many rows, see `tileRows`,
+/// otherwise every thread sweeps a single band.
+/// \return The disparity map.
+Pixelsi calcDepthMap(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD, int maxD,
+                     bool invertD, MatchingCost::Kind cost = MatchingCost::Kind::Zncc, int tile = 0);
+
+/// Finds the best disparity for every pixel of the left image like `calcDepthMap`, and finds the second best
+/// score in the same pass, excluding the disparities next to the final best one. The confidence of a pixel is
+/// `1 - (PERFECT - best) / (PERFECT - second)` of the scores, see `MatchingCost`: 0 if the two are equal,
+/// 1 if the best window is identical.
+/// Throws an `std::exception` if the aprons of the planes are smaller than required.
+/// \param leftCalc Precomputed data of the left image, with an apron of at least `window / 2`.
+/// \param rightCalc Precomputed data of the right image, with an apron of at least `window / 2 + maxD`.
+/// \param window Window size.
+/// \param minD The first disparity to search.
+/// \param maxD The end of the searched disparity range, exclusive.
+/// \param invertD Should be true, if the order of left and right pixel data is reversed.
+/// \param cost The matching cost, both images must have its planes.
+/// \param tile If positive, the rows are dealt out to the threads in tiles of this many rows.
+/// \return The disparity map, the same as `calcDepthMap` returns, and the confidence of every pixel.
+ConfidentDepthMap calcConfidentDepthMap(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD,
+                                        int maxD, bool invertD, MatchingCost::Kind cost = MatchingCost::Kind::Zncc,
+                                        int tile = 0);
+
+}   // namespace WindowSweep
+
+
+#endif //DISPARITY_CPU_WINDOWSWEEP_HPP
@@ -0,0 +1,72 @@
+#ifndef DISPARITY_CPU_WORKERS_HPP
+#define DISPARITY_CPU_WORKERS_HPP
+
+
+#include <vector>
+#include <atomic>
+#include <future>
+#include <algorithm>
+#include "CliOptions.hpp"
+
+
+/// Provides the thread pool-less worker infrastructure shared by the image processing stages.
+namespace Workers {
+
+/// Splits the `[0, count)` range into contiguous bands, and processes each band on its own thread.
+/// The number of bands is given by `CliOptions::getThreads()`.
+/// \tparam Tfun The type of the band processing function.
+/// \param count The number of items (usually rows) to process.
+/// \param fun Called with the first and the one-past-last index of a band.
+template<typename Tfun>
+void forEachBand(int count, const Tfun& fun) {
+    const int threads = std::max(1, std::min(CliOptions::getThreads(), count));
+
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < threads; ++i) {
+        const int begin = count * i / threads;
+        const int end = count * (i + 1) / threads;
+        futures.push_back(std::async(std::launch::async, [begin, end, &fun]() {
+            fun(begin, end);
+        }));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+}
+
+/// Splits the `[0, count)` range into tiles of `tile` items, and deals them out to the threads one at a time,
+/// so a thread working on cheaper tiles takes more of them. Each thread claims its next tile before processing the
+/// current one, so the data of the next tile can be prefetched. The number of threads is given by
+/// `CliOptions::getThreads()`.
+/// \tparam Tfun The type of the tile processing function.
+/// \param count The number of items (usually rows) to process.
+/// \param tile The number of items in a tile, the last tile may be shorter.
+/// \param fun Called with the first and the one-past-last index of a tile, then of the next tile of the thread,
+/// which is an empty range at the last one.
+template<typename Tfun>
+void forEachTile(int count, int tile, const Tfun& fun) {
+    tile = std::max(1, tile);
+    const int tiles = (count + tile - 1) / tile;
+    const int threads = std::max(1, std::min(CliOptions::getThreads(), tiles));
+
+    std::atomic<int> nextTile(0);
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < threads; ++i) {
+        futures.push_back(std::async(std::launch::async, [count, tile, &nextTile, &fun]() {
+            int begin = std::min(count, tile * nextTile++);
+            while (begin < count) {
+                const int nextBegin = std::min(count, tile * nextTile++);
+                fun(begin, std::min(count, begin + tile), nextBegin, std::min(count, nextBegin + tile));
+                begin = nextBegin;
+            }
+        }));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+}
+
+}   // namespace Workers
+
+
+#endif //DISPARITY_CPU_WORKERS_HPP
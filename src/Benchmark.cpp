@@ -0,0 +1,96 @@
+#include <cstring>
+#include "Benchmark.hpp"
+#include "Logger.hpp"
+#include "CliOptions.hpp"
+#include "Kernels.hpp"
+#include "PixelCalc.hpp"
+#include "SimdZncc.hpp"
+#include "Census.hpp"
+
+
+namespace {
+
+const char* BASELINE = "avx2";
+const int REPEATS = 3;
+
+
+/// Returns the shortest of a few run times of a function in seconds.
+template<typename Tfun>
+float measure(const Tfun& fun) {
+    float best = 0.0f;
+    for (int i = 0; i < REPEATS; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        fun();
+        const std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - start;
+        if (i == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+
+/// Measures a kernel with every variant, and logs the results relative to the baseline variant.
+template<typename Tfun>
+void compareVariants(const char* kernelName, const std::vector<const Kernels::Table*>& variants, const Tfun& fun) {
+    std::vector<float> times;
+    const char* baseline = variants.front()->name;
+    float baselineTime = 0.0f;
+    for (const auto kernels : variants) {
+        times.push_back(measure([&fun, kernels]() { fun(*kernels); }));
+        if (strcmp(kernels->name, BASELINE) == 0 || kernels == variants.front()) {
+            baseline = kernels->name;
+            baselineTime = times.back();
+        }
+    }
+    for (int i = 0; i < variants.size(); ++i) {
+        Logger::logBenchmark(kernelName, variants[i]->name, times[i], baselineTime / times[i], baseline);
+    }
+}
+
+}
+
+
+void Benchmark::runKernels(const Pixelsf& leftPixels, const Pixelsf& rightPixels, int window, int minD, int maxD) {
+    const auto variants = Kernels::available();
+    const int width = leftPixels.getWidth();
+    const int height = leftPixels.getHeight();
+
+    const IntegralImage sums(leftPixels, window / 2, false);
+    const IntegralImage squareSums(leftPixels, window / 2, true);
+    std::vector<float> means(leftPixels.getData().size());
+    std::vector<float> centered(leftPixels.getData().size());
+    std::vector<float> invStds(leftPixels.getData().size());
+    compareVariants("window statistics", variants, [&](const Kernels::Table& kernels) {
+        for (int row = 0; row < height; ++row) {
+            const int offset = row * width;
+            kernels.windowStatistics(sums.windowTopRow(row, window), sums.windowBottomRow(row, window),
+                                     squareSums.windowTopRow(row, window), squareSums.windowBottomRow(row, window),
+                                     &leftPixels.getData()[offset], width, window,
+                                     &means[offset], &centered[offset], &invStds[offset]);
+        }
+    });
+
+    // the window cache takes `window * window` copies of the images, it is only measured when enabled
+    const bool cached = CliOptions::getWindowCache();
+    const unsigned planes = PixelCalc::StatisticsPlanes | (cached ? PixelCalc::WindowCachePlane : 0u);
+    const auto leftCalc = PixelCalc::calculatePixelCalc(leftPixels, window, window / 2 + maxD, planes);
+    const auto rightCalc = PixelCalc::calculatePixelCalc(rightPixels, window, window / 2 + maxD, planes);
+    compareVariants("zncc, disparity lanes", variants, [&](const Kernels::Table& kernels) {
+        SimdZncc::calcDepthMapDisparityLanes(leftCalc, rightCalc, window, minD, maxD, false, kernels);
+    });
+    compareVariants("zncc, row lanes", variants, [&](const Kernels::Table& kernels) {
+        SimdZncc::calcDepthMapRowLanes(leftCalc, rightCalc, window, minD, maxD, false, kernels);
+    });
+    if (cached) {
+        compareVariants("zncc, row lanes from the window cache", variants, [&](const Kernels::Table& kernels) {
+            SimdZncc::calcDepthMapCachedRowLanes(leftCalc, rightCalc, window, minD, maxD, false, kernels);
+        });
+    }
+    compareVariants("zncc, both maps from row lanes", variants, [&](const Kernels::Table& kernels) {
+        SimdZncc::calcDepthMapsRowLanes(leftCalc, rightCalc, window, minD, maxD, kernels);
+    });
+    compareVariants("census, hamming distances", variants, [&](const Kernels::Table& kernels) {
+        Census::calcDepthMap(leftPixels, rightPixels, window, minD, maxD, false, kernels);
+    });
+}
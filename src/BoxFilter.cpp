@@ -0,0 +1,200 @@
+#include "BoxFilter.hpp"
+#include "Workers.hpp"
+
+
+namespace {
+
+/// Box-filters the cost term images of the disparities in `[minD, maxD)`, and passes every score to a visitor.
+/// The rows are split into bands, `makeVisitor(begin, end)` is called on the thread of a band, and returns
+/// the visitor called with `(row, col, disp, score)` for every score of the band. A pixel gets its scores
+/// in increasing order of disparity.
+template<typename Tcost, typename TmakeVisitor>
+void scoreBands(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD, int maxD, bool invertD,
+                const TmakeVisitor& makeVisitor) {
+    const int width = leftCalc.pixels().getWidth();
+    const int height = leftCalc.pixels().getHeight();
+    const int r = window / 2;
+    // the term row covers the columns [-r, width + r), the right image is shifted by at most maxD - 1
+    const int span = width + 2 * r;
+    if (leftCalc.apron() < r || rightCalc.apron() < r + maxD) {
+        throw std::exception();
+    }
+
+    Workers::forEachBand(height, [&](int begin, int end) {
+        auto visit = makeVisitor(begin, end);
+        Tcost cost(leftCalc, rightCalc, Kernels::active());
+        std::vector<double> columnSums(span);
+        std::vector<float> terms(span);
+
+        for (int disp = minD; disp < maxD; ++disp) {
+            const int d = invertD ? -disp : disp;
+
+            // adds the term row of an image row to the column sums, rows outside the image are in the apron
+            auto accumulate = [&](int row, double sign) {
+                cost.terms(row, -r, d, span, terms.data());
+                for (int i = 0; i < span; ++i) {
+                    columnSums[i] += sign * terms[i];
+                }
+            };
+
+            std::fill(columnSums.begin(), columnSums.end(), 0.0);
+            for (int row = begin - r; row <= begin + r; ++row) {
+                accumulate(row, 1.0);
+            }
+
+            for (int row = begin; row < end; ++row) {
+                double boxSum = 0.0;
+                for (int i = 0; i < window - 1; ++i) {
+                    boxSum += columnSums[i];
+                }
+                for (int col = 0; col < width; ++col) {
+                    boxSum += columnSums[col + window - 1];
+                    const float score = cost.score(boxSum, row, col, d);
+                    boxSum -= columnSums[col];
+                    visit(row, col, disp, score);
+                }
+                if (row + 1 < end) {
+                    accumulate(row + r + 1, 1.0);
+                    accumulate(row - r, -1.0);
+                }
+            }
+        }
+    });
+}
+
+}
+
+
+Pixelsi BoxFilter::calcDepthMap(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD, int maxD,
+                                bool invertD, MatchingCost::Kind cost) {
+    const int width = leftCalc.pixels().getWidth();
+    const int height = leftCalc.pixels().getHeight();
+    std::vector<int> result(static_cast<size_t>(width) * height, minD);
+    MatchingCost::dispatch(cost, [&](auto costType) {
+        using Cost = std::remove_pointer_t<decltype(costType)>;
+        scoreBands<Cost>(leftCalc, rightCalc, window, minD, maxD, invertD, [&](int begin, int end) {
+            std::vector<float> bandScores(static_cast<size_t>(end - begin) * width, Cost::WORST);
+            return [&result, bestScores = std::move(bandScores), begin, width](int row, int col, int disp,
+                                                                               float score) mutable {
+                float& bestScore = bestScores[(row - begin) * width + col];
+                if (score > bestScore) {
+                    bestScore = score;
+                    result[row * width + col] = disp;
+                }
+            };
+        });
+    });
+
+    return Pixelsi(std::move(result), width, height);
+}
+
+
+void BoxFilter::calcCostVolume(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, bool invertD,
+                               CostVolume& volume) {
+    if (volume.getWidth() != leftCalc.pixels().getWidth() || volume.getHeight() != leftCalc.pixels().getHeight()) {
+        throw std::exception();
+    }
+    scoreBands<MatchingCost::Zncc>(leftCalc, rightCalc, window, volume.getMinD(), volume.getMaxD(), invertD,
+                                   [&volume](int begin, int end) {
+        auto band = volume.band(begin, end);
+        return [band](int row, int col, int disp, float zncc) mutable {
+            band.set(row, col, disp, zncc);
+        };
+    });
+}
+
+
+DepthMaps BoxFilter::streamDepthMaps(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD,
+                                     int maxD) {
+    const int width = leftCalc.pixels().getWidth();
+    const int height = leftCalc.pixels().getHeight();
+    const int r = window / 2;
+    const int span = width + 2 * r;
+    const Pixelsf& left = leftCalc.centered();
+    const Pixelsf& right = rightCalc.centered();
+    const Pixelsf& leftInvStds = leftCalc.invStds();
+    const Pixelsf& rightInvStds = rightCalc.invStds();
+    if (left.getApron() < r || right.getApron() < r + maxD) {
+        throw std::exception();
+    }
+
+    std::vector<int> leftResult(static_cast<size_t>(width) * height, minD);
+    std::vector<int> rightResult(static_cast<size_t>(width) * height, minD);
+    Workers::forEachBand(height, [&](int begin, int end) {
+        // one more row than the windows, so the next row is added before the oldest one is removed,
+        // in the same order as in scoreBands
+        auto products = CostVolume::ringBuffer(span, window + 1, minD, maxD, CostVolume::Layout::ColumnInner,
+                                               CostVolume::Storage::Float32);
+        std::vector<double> columnSums(static_cast<size_t>(span) * (maxD - minD));
+        std::vector<float> leftScores(width);
+        std::vector<float> rightScores(width);
+
+        auto addRow = [&](int row) {
+            for (int disp = minD; disp < maxD; ++disp) {
+                const float* leftRow = left.getRow(row) - r;
+                const float* rightRow = right.getRow(row) - r - disp;
+                float* product = products.scores(row, disp);
+                double* sums = &columnSums[static_cast<size_t>(disp - minD) * span];
+                for (int i = 0; i < span; ++i) {
+                    product[i] = leftRow[i] * rightRow[i];
+                    sums[i] += product[i];
+                }
+            }
+        };
+        auto removeRow = [&](int row) {
+            for (int disp = minD; disp < maxD; ++disp) {
+                const float* product = products.scores(row, disp);
+                double* sums = &columnSums[static_cast<size_t>(disp - minD) * span];
+                for (int i = 0; i < span; ++i) {
+                    sums[i] -= product[i];
+                }
+            }
+        };
+
+        for (int row = begin - r; row <= begin + r; ++row) {
+            addRow(row);
+        }
+        for (int row = begin; row < end; ++row) {
+            std::fill(leftScores.begin(), leftScores.end(), 0.0f);
+            std::fill(rightScores.begin(), rightScores.end(), 0.0f);
+            int* leftBest = &leftResult[row * width];
+            int* rightBest = &rightResult[row * width];
+            for (int disp = minD; disp < maxD; ++disp) {
+                const double* sums = &columnSums[static_cast<size_t>(disp - minD) * span];
+                double boxSum = 0.0;
+                for (int i = 0; i < window - 1; ++i) {
+                    boxSum += sums[i];
+                }
+                for (int col = 0; col < width; ++col) {
+                    boxSum += sums[col + window - 1];
+                    const float zncc = static_cast<float>(boxSum)
+                                       * leftInvStds.getUnclamped(row, col) * rightInvStds.getUnclamped(row, col - disp);
+                    boxSum -= sums[col];
+
+                    // the right pixel col - disp gets its disparities in increasing order, as the left one does
+                    if (zncc > leftScores[col]) {
+                        leftScores[col] = zncc;
+                        leftBest[col] = disp;
+                    }
+                    if (col >= disp && zncc > rightScores[col - disp]) {
+                        rightScores[col - disp] = zncc;
+                        rightBest[col - disp] = disp;
+                    }
+                }
+            }
+            if (row + 1 < end) {
+                addRow(row + r + 1);
+                removeRow(row - r);
+            }
+        }
+    });
+
+    return { Pixelsi(std::move(leftResult), width, height), Pixelsi(std::move(rightResult), width, height) };
+}
+
+
+size_t BoxFilter::streamBytes(int width, int window, int disparities) {
+    const int span = width + 2 * (window / 2);
+    return CostVolume::bytesRequired(span, window + 1, disparities, CostVolume::Storage::Float32)
+           + static_cast<size_t>(span) * disparities * sizeof(double);
+}
@@ -0,0 +1,99 @@
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <algorithm>
+#include "Calibration.hpp"
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <sstream>
+#include "../thirdparty/doctest.h"
+#endif
+
+
+namespace {
+
+float parseNumber(const std::string& text) {
+    try {
+        return std::stof(text);
+    } catch (const std::logic_error&) {
+        throw std::exception();
+    }
+}
+
+}
+
+
+Calibration Calibration::load(const char* filename) {
+    std::ifstream file(filename);
+    if (!file) {
+        return Calibration();
+    }
+    return parse(file);
+}
+
+
+Calibration Calibration::parse(std::istream& input) {
+    Calibration calibration;
+    bool hasVmax = false;
+    std::string line;
+    while (std::getline(input, line)) {
+        // the camera matrices and the other fields are not used
+        const auto separator = line.find('=');
+        if (separator == std::string::npos) {
+            continue;
+        }
+        const auto key = line.substr(0, separator);
+        const auto value = line.substr(separator + 1);
+        if (key == "ndisp") {
+            calibration.m_ndisp = static_cast<int>(parseNumber(value));
+        } else if (key == "vmin") {
+            calibration.m_vmin = parseNumber(value);
+        } else if (key == "vmax") {
+            calibration.m_vmax = parseNumber(value);
+            hasVmax = true;
+        }
+    }
+
+    if (!hasVmax) {
+        calibration.m_vmax = static_cast<float>(calibration.m_ndisp - 1);
+    }
+    if (calibration.m_ndisp <= 0 || calibration.m_vmin < 0.0f || calibration.m_vmax < calibration.m_vmin) {
+        throw std::exception();
+    }
+    calibration.m_loaded = true;
+    return calibration;
+}
+
+
+DisparityRange Calibration::range(int factor) const {
+    const int limit = std::max(m_ndisp / factor, 1);
+    const int min = std::min(static_cast<int>(std::floor(m_vmin / factor)), limit - 1);
+    const int max = std::min(static_cast<int>(std::ceil(m_vmax / factor)) + 1, limit);
+    return { min, std::max(max, min + 1) };
+}
+
+
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+TEST_CASE("testing calibration file parsing") {
+    std::istringstream file(
+            "cam0=[3997.684 0 1176.728; 0 3997.684 1011.728; 0 0 1]\n"
+            "doffs=131.111\n"
+            "ndisp=280\n"
+            "vmin=31\n"
+            "vmax=257\n");
+    const auto calibration = Calibration::parse(file);
+    CHECK(calibration.loaded());
+    CHECK(calibration.range(1).min == 31);
+    CHECK(calibration.range(1).max == 258);
+    CHECK(calibration.range(4).min == 7);
+    CHECK(calibration.range(4).max == 66);
+
+    const auto defaults = Calibration::load("no such file");
+    CHECK_FALSE(defaults.loaded());
+    CHECK(defaults.range(4).min == 0);
+    CHECK(defaults.range(4).max == 65);
+
+    std::istringstream broken("vmin=abc\n");
+    CHECK_THROWS(Calibration::parse(broken));
+}
+#endif
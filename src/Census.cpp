@@ -0,0 +1,138 @@
+#include <limits>
+#include "Census.hpp"
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "../thirdparty/doctest.h"
+#endif
+
+
+int Census::descriptorWords(int window) {
+    return std::max(1, (window * window - 1 + 63) / 64);
+}
+
+
+Census::Descriptors Census::transform(const Pixelsf& pixels, int window) {
+    const int width = pixels.getWidth();
+    const int height = pixels.getHeight();
+    const int words = descriptorWords(window);
+    const int D = window / 2;
+    const Pixelsf padded(std::vector<float>(pixels.getData()), width, height, D);
+
+    std::vector<std::vector<uint64_t>> planes(words, std::vector<uint64_t>(static_cast<size_t>(width) * height));
+    Workers::forEachBand(height, [&](int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+            for (int col = 0; col < width; ++col) {
+                const float center = padded.getUnclamped(row, col);
+                uint64_t word = 0;
+                int bit = 0;
+                for (int y = row - D; y <= row + D; ++y) {
+                    const float* windowRow = padded.getRow(y);
+                    for (int x = col - D; x <= col + D; ++x) {
+                        if (y == row && x == col) {
+                            continue;
+                        }
+                        word |= static_cast<uint64_t>(windowRow[x] < center) << (bit % 64);
+                        if (++bit % 64 == 0) {
+                            planes[bit / 64 - 1][row * width + col] = word;
+                            word = 0;
+                        }
+                    }
+                }
+                if (bit % 64 != 0) {
+                    planes[bit / 64][row * width + col] = word;
+                }
+            }
+        }
+    });
+
+    Descriptors descriptors;
+    for (auto& plane : planes) {
+        descriptors.emplace_back(std::move(plane), width, height);
+    }
+    return descriptors;
+}
+
+
+Pixelsi Census::calcDepthMap(const Pixelsf& leftPixels, const Pixelsf& rightPixels, int window, int minD, int maxD,
+                             bool invertD, const Kernels::Table& kernels) {
+    const int width = leftPixels.getWidth();
+    const int height = leftPixels.getHeight();
+    const int stride = width + 2 * maxD;
+    const auto leftDescriptors = transform(leftPixels, window);
+    const auto rightDescriptors = transform(rightPixels, window);
+
+    // the padding repeats the edge descriptors, so the pairs outside the right image can be read
+    std::vector<std::vector<uint64_t>> leftWords, rightWords;
+    for (const auto& plane : leftDescriptors) {
+        leftWords.push_back(plane.getPaddedRows(maxD));
+    }
+    for (const auto& plane : rightDescriptors) {
+        rightWords.push_back(plane.getPaddedRows(maxD));
+    }
+
+    std::vector<int> result(static_cast<size_t>(width) * height, minD);
+    Workers::forEachBand(height, [&](int begin, int end) {
+        std::vector<int> distances(width);
+        std::vector<int> bestDistances(width);
+        for (int row = begin; row < end; ++row) {
+            const size_t offset = static_cast<size_t>(row) * stride + maxD;
+            int* bestDisps = &result[row * width];
+            std::fill(bestDistances.begin(), bestDistances.end(), std::numeric_limits<int>::max());
+            for (int disp = minD; disp < maxD; ++disp) {
+                std::fill(distances.begin(), distances.end(), 0);
+                for (size_t word = 0; word < leftWords.size(); ++word) {
+                    const uint64_t* rightRow = &rightWords[word][offset] - (invertD ? -disp : disp);
+                    kernels.hammingDistances(&leftWords[word][offset], rightRow, width, distances.data());
+                }
+                for (int col = 0; col < width; ++col) {
+                    if (distances[col] < bestDistances[col]) {
+                        bestDistances[col] = distances[col];
+                        bestDisps[col] = disp;
+                    }
+                }
+            }
+        }
+    });
+
+    return Pixelsi(std::move(result), width, height);
+}
+
+
+
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+TEST_CASE("check if the census engine finds a constant shift") {
+    const int width = 64, height = 24, shift = 5, minD = 2, maxD = 20;
+    const auto images = shiftedPair(width, height, shift);
+    const Pixelsf& left = images.first;
+    const Pixelsf& right = images.second;
+
+    // 9 needs 2 words per descriptor, 7 a single one
+    for (int window : { 7, 9 }) {
+        CHECK(Census::descriptorWords(window) == (window == 9 ? 2 : 1));
+        for (const auto kernels : Kernels::available()) {
+            const auto leftMap = Census::calcDepthMap(left, right, window, minD, maxD, false, *kernels);
+            const auto rightMap = Census::calcDepthMap(right, left, window, minD, maxD, true, *kernels);
+            for (int row = 0; row < height; ++row) {
+                for (int col = shift + window; col < width - window; ++col) {
+                    CHECK(leftMap.get(row, col) == shift);
+                    CHECK(rightMap.get(row, col - shift) == shift);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("check if the Hamming distances count the differing bits") {
+    std::vector<uint64_t> left(21), right(21);
+    for (int i = 0; i < left.size(); ++i) {
+        left[i] = (uint64_t(1) << i) - 1;
+        right[i] = i % 2 == 0 ? 0 : ~uint64_t(0);
+    }
+    for (const auto kernels : Kernels::available()) {
+        std::vector<int> distances(left.size(), 1);
+        kernels->hammingDistances(left.data(), right.data(), static_cast<int>(left.size()), distances.data());
+        for (int i = 0; i < left.size(); ++i) {
+            CHECK(distances[i] == 1 + (i % 2 == 0 ? i : 64 - i));
+        }
+    }
+}
+#endif
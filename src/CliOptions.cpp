@@ -1,4 +1,9 @@
+#include <limits>
+#include <map>
 #include "CliOptions.hpp"
+#include "CostVolume.hpp"
+#include "MatchingCost.hpp"
+#include "SubPixel.hpp"
 #include "cxxopts.hpp"
 
 
@@ -7,27 +12,133 @@ namespace {
 const char* PROG_NAME = "Disparity Calculator";
 const char* PROG_DESC = "";
 
+const std::map<std::string, CliOptions::Engine> ENGINES = {
+        { "window",     CliOptions::Engine::Window },
+        { "box",        CliOptions::Engine::BoxFilter },
+        { "simd-disp",  CliOptions::Engine::SimdDisparity },
+        { "simd-row",   CliOptions::Engine::SimdRow },
+        { "int",        CliOptions::Engine::Integer },
+        { "census",     CliOptions::Engine::Census },
+};
+
 }
 
 
 int CliOptions::threads = 0;
 int CliOptions::window = 0;
+int CliOptions::downscale = 4;
+int CliOptions::levels = 1;
+CliOptions::Engine CliOptions::engine = CliOptions::Engine::Window;
+std::string CliOptions::isa = "auto";
+bool CliOptions::benchmark = false;
+bool CliOptions::joint = false;
+std::string CliOptions::costVolume = "none";
+std::string CliOptions::costLayout = "disparity";
+bool CliOptions::stream = false;
+int CliOptions::sgmPaths = 0;
+std::string CliOptions::cost = "zncc";
+bool CliOptions::tiles = false;
+bool CliOptions::windowCache = false;
+float CliOptions::uniqueness = 0.0f;
+std::string CliOptions::subPixel = "none";
+bool CliOptions::hugePages = false;
 
 
 void CliOptions::parse(int argc, const char* argv[]) {
     cxxopts::Options options(PROG_NAME, PROG_DESC);
     options.add_options()
             ("t,threads", "Set number of threads to use", cxxopts::value<int>()->default_value("1"))
-    // TODO window from cli
-            ("w,window", "Set window size", cxxopts::value<int>()->default_value("9"));
+            ("w,window", "Set window size, an odd number", cxxopts::value<int>()->default_value("9"))
+            ("s,downscale", "Set the factor the input images are shrunk by", cxxopts::value<int>()->default_value("4"))
+            ("l,levels", "Set the number of pyramid levels, 1 searches all disparities at every pixel (not with the int and census engines)", cxxopts::value<int>()->default_value("1"))
+            ("e,engine", "Set matching engine (window, box, simd-disp, simd-row, int, census)", cxxopts::value<std::string>()->default_value("window"))
+            ("isa", "Set kernel instruction set (auto, scalar, avx, avx2, avx512)", cxxopts::value<std::string>()->default_value("auto"))
+            ("b,benchmark", "Compare the kernel variants instead of calculating the depth map")
+            ("j,joint", "Derive the right depth map from the scores of the left one (simd-row engine, 1 level)")
+            ("c,cost-volume", "Store the scores in a cost volume (none, fp32, fp16, int16; box engine, 1 level)", cxxopts::value<std::string>()->default_value("none"))
+            ("layout", "Set the innermost dimension of the cost volume (disparity, column; with cost-volume only)", cxxopts::value<std::string>()->default_value("disparity"))
+            ("stream", "Keep only the costs of the current windows in a ring buffer instead of a cost volume (box engine, 1 level)")
+            ("sgm", "Smooth the costs along 4 or 8 paths with semi-global matching, 0 disables it (box engine, 1 level, not with stream or cost-volume)", cxxopts::value<int>()->default_value("0"))
+            ("cost", "Set the matching cost (zncc, sad, ssd, census; window and box engines, 1 level)", cxxopts::value<std::string>()->default_value("zncc"))
+            ("tiles", "Deal the rows out to the threads in tiles sized for the L2 cache instead of a band per thread (window engine)")
+            ("window-cache", "Read the windows from aligned copies of every window element instead of the centered planes (simd-row engine, not with joint)")
+            ("uniqueness", "Validate the left depth map by the confidence of its scores instead of cross-checking a right one, the least confidence kept in 0-1, 0 disables it (window engine, 1 level)", cxxopts::value<float>()->default_value("0"))
+            ("subpixel", "Refine the disparities to fractions of a pixel (none, parabola, equiangular; not with the int and census engines, cost-volume, stream or sgm)", cxxopts::value<std::string>()->default_value("none"))
+            ("huge-pages", "Back the apron planes and scratch chunks of 2 MiB or more by transparent huge pages (Linux)");
     auto result = options.parse(argc, argv);
 
     threads = result["threads"].as<int>();
     window = result["window"].as<int>();
+    downscale = result["downscale"].as<int>();
+    levels = result["levels"].as<int>();
+
+    joint = result["joint"].as<bool>();
 
-    if (threads <= 0 || window <= 0) {
+    const auto engineIt = ENGINES.find(result["engine"].as<std::string>());
+    if (threads <= 0 || window <= 0 || window % 2 == 0 || downscale <= 0 || levels <= 0
+        || engineIt == ENGINES.end()) {
+        throw std::exception();
+    }
+    engine = engineIt->second;
+    // the pyramid refines with the ZNCC band kernel, which would mix two engines, and main runs
+    // the integer engine on the full images without a pyramid
+    if ((engine == Engine::Census || engine == Engine::Integer) && levels != 1) {
+        throw std::exception();
+    }
+    if (joint && (engine != Engine::SimdRow || levels != 1)) {
+        throw std::exception();
+    }
+    costVolume = result["cost-volume"].as<std::string>();
+    costLayout = result["layout"].as<std::string>();
+    if (costVolume != "none") {
+        CostVolume::parseStorage(costVolume);
+    }
+    CostVolume::parseLayout(costLayout);
+    // the layout only applies to a stored cost volume
+    if (result.count("layout") != 0 && costVolume == "none") {
+        throw std::exception();
+    }
+    stream = result["stream"].as<bool>();
+    sgmPaths = result["sgm"].as<int>();
+    if (sgmPaths != 0 && sgmPaths != 4 && sgmPaths != 8) {
+        throw std::exception();
+    }
+    if ((costVolume != "none" || stream || sgmPaths != 0) && (engine != Engine::BoxFilter || levels != 1)) {
+        throw std::exception();
+    }
+    // each of them replaces the search of both maps, at most one may be chosen
+    if ((costVolume != "none") + stream + (sgmPaths != 0) > 1) {
         throw std::exception();
     }
+    cost = result["cost"].as<std::string>();
+    MatchingCost::parse(cost);
+    if (cost != "zncc" && ((engine != Engine::Window && engine != Engine::BoxFilter) || levels != 1
+                           || costVolume != "none" || stream || sgmPaths != 0)) {
+        throw std::exception();
+    }
+    tiles = result["tiles"].as<bool>();
+    if (tiles && engine != Engine::Window) {
+        throw std::exception();
+    }
+    windowCache = result["window-cache"].as<bool>();
+    if (windowCache && (engine != Engine::SimdRow || joint)) {
+        throw std::exception();
+    }
+    uniqueness = result["uniqueness"].as<float>();
+    if (uniqueness < 0.0f || uniqueness > 1.0f || (uniqueness > 0.0f && (engine != Engine::Window || levels != 1))) {
+        throw std::exception();
+    }
+    subPixel = result["subpixel"].as<std::string>();
+    // the refinement re-scores the neighbours of the winner with the --cost window scores, which are not
+    // the costs the census engine, the aggregation and the stored volumes choose it by
+    if (subPixel != "none" && (engine == Engine::Integer || engine == Engine::Census
+                               || costVolume != "none" || stream || sgmPaths != 0)) {
+        throw std::exception();
+    }
+    SubPixel::parse(subPixel);
+    hugePages = result["huge-pages"].as<bool>();
+    isa = result["isa"].as<std::string>();
+    benchmark = result["benchmark"].as<bool>();
 }
 
 
@@ -39,3 +150,93 @@ int CliOptions::getThreads() {
 int CliOptions::getWindow() {
     return window;
 }
+
+
+int CliOptions::getDownscale() {
+    return downscale;
+}
+
+
+int CliOptions::getLevels() {
+    return levels;
+}
+
+
+CliOptions::Engine CliOptions::getEngine() {
+    return engine;
+}
+
+
+const std::string& CliOptions::getIsa() {
+    return isa;
+}
+
+
+bool CliOptions::getBenchmark() {
+    return benchmark;
+}
+
+
+bool CliOptions::getJoint() {
+    return joint;
+}
+
+
+const std::string& CliOptions::getCostVolume() {
+    return costVolume;
+}
+
+
+const std::string& CliOptions::getCostLayout() {
+    return costLayout;
+}
+
+
+bool CliOptions::getStream() {
+    return stream;
+}
+
+
+int CliOptions::getSgmPaths() {
+    return sgmPaths;
+}
+
+
+const std::string& CliOptions::getCost() {
+    return cost;
+}
+
+
+bool CliOptions::getTiles() {
+    return tiles;
+}
+
+
+bool CliOptions::getWindowCache() {
+    return windowCache;
+}
+
+
+float CliOptions::getUniqueness() {
+    return uniqueness;
+}
+
+
+const std::string& CliOptions::getSubPixel() {
+    return subPixel;
+}
+
+
+bool CliOptions::getHugePages() {
+    return hugePages;
+}
+
+
+const char* CliOptions::getEngineName() {
+    for (const auto& entry : ENGINES) {
+        if (entry.second == engine) {
+            return entry.first.c_str();
+        }
+    }
+    return "";
+}
@@ -0,0 +1,170 @@
+#include <map>
+#include "CostVolume.hpp"
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "../thirdparty/doctest.h"
+#endif
+
+
+constexpr float CostVolume::INT16_SCALE;
+
+
+CostVolume::CostVolume(int width, int height, int minD, int maxD, Layout layout, Storage storage) :
+        m_width     (width),
+        m_height    (height),
+        m_minD      (minD),
+        m_maxD      (maxD),
+        m_layout    (layout),
+        m_storage   (storage)
+{
+    if (width <= 0 || height <= 0 || minD < 0 || maxD <= minD) {
+        throw std::exception();
+    }
+    const size_t count = static_cast<size_t>(width) * height * (maxD - minD);
+    if (storage == Storage::Float32) {
+        m_floats.resize(count);
+    } else {
+        m_compact.resize(count);
+    }
+}
+
+
+CostVolume CostVolume::ringBuffer(int width, int rows, int minD, int maxD, Layout layout, Storage storage) {
+    CostVolume ring(width, rows, minD, maxD, layout, storage);
+    ring.m_ring = true;
+    return ring;
+}
+
+
+size_t CostVolume::bytesRequired(int width, int height, int disparities, Storage storage) {
+    const size_t elementSize = storage == Storage::Float32 ? sizeof(float) : sizeof(uint16_t);
+    return static_cast<size_t>(width) * height * disparities * elementSize;
+}
+
+
+CostVolume::Storage CostVolume::parseStorage(const std::string& name) {
+    const std::map<std::string, Storage> STORAGES = {
+            { "fp32",   Storage::Float32 },
+            { "fp16",   Storage::Float16 },
+            { "int16",  Storage::Int16 },
+    };
+    const auto it = STORAGES.find(name);
+    if (it == STORAGES.end()) {
+        throw std::exception();
+    }
+    return it->second;
+}
+
+
+CostVolume::Layout CostVolume::parseLayout(const std::string& name) {
+    const std::map<std::string, Layout> LAYOUTS = {
+            { "disparity",  Layout::DisparityInner },
+            { "column",     Layout::ColumnInner },
+    };
+    const auto it = LAYOUTS.find(name);
+    if (it == LAYOUTS.end()) {
+        throw std::exception();
+    }
+    return it->second;
+}
+
+
+Pixelsi CostVolume::bestLeft() const {
+    std::vector<int> result(static_cast<size_t>(m_width) * m_height, m_minD);
+    Workers::forEachBand(m_height, [&](int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+            for (int col = 0; col < m_width; ++col) {
+                float bestScore = 0.0f;
+                for (int disp = m_minD; disp < m_maxD; ++disp) {
+                    const float score = get(row, col, disp);
+                    if (score > bestScore) {
+                        bestScore = score;
+                        result[row * m_width + col] = disp;
+                    }
+                }
+            }
+        }
+    });
+    return Pixelsi(std::move(result), m_width, m_height);
+}
+
+
+Pixelsi CostVolume::bestRight() const {
+    std::vector<int> result(static_cast<size_t>(m_width) * m_height, m_minD);
+    Workers::forEachBand(m_height, [&](int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+            for (int col = 0; col < m_width; ++col) {
+                float bestScore = 0.0f;
+                for (int disp = m_minD; disp < m_maxD && col + disp < m_width; ++disp) {
+                    const float score = get(row, col + disp, disp);
+                    if (score > bestScore) {
+                        bestScore = score;
+                        result[row * m_width + col] = disp;
+                    }
+                }
+            }
+        }
+    });
+    return Pixelsi(std::move(result), m_width, m_height);
+}
+
+
+
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+TEST_CASE("check if the cost volume stores and finds the scores in every format") {
+    const int width = 7, height = 3, minD = 2, maxD = 6;
+    for (auto layout : { CostVolume::Layout::DisparityInner, CostVolume::Layout::ColumnInner }) {
+        for (auto storage : { CostVolume::Storage::Float32, CostVolume::Storage::Float16,
+                              CostVolume::Storage::Int16 }) {
+            CostVolume volume(width, height, minD, maxD, layout, storage);
+            const size_t elementSize = storage == CostVolume::Storage::Float32 ? 4 : 2;
+            CHECK(volume.getBytes() == width * height * (maxD - minD) * elementSize);
+            CHECK(volume.bestLeft().getData() == std::vector<int>(width * height, minD));
+
+            // every left pixel matches best at disparity 3, the right pixels at column + 3
+            auto band = volume.band(1, 2);
+            for (int col = 0; col < width; ++col) {
+                for (int disp = minD; disp < maxD; ++disp) {
+                    band.set(1, col, disp, disp == 3 ? 0.75f : -0.5f + 0.01f * col);
+                }
+            }
+            CHECK(volume.get(1, 4, 3) == doctest::Approx(0.75f).epsilon(0.001));
+            CHECK(volume.get(1, 6, 5) == doctest::Approx(-0.44f).epsilon(0.001));
+            CHECK(volume.get(0, 6, 5) == 0.0f);
+
+            const auto left = volume.bestLeft();
+            const auto right = volume.bestRight();
+            for (int col = 0; col < width; ++col) {
+                CHECK(left.get(1, col) == 3);
+                CHECK(right.get(1, col) == (col + 3 < width ? 3 : minD));
+                CHECK(left.get(0, col) == minD);
+            }
+        }
+    }
+}
+
+TEST_CASE("check if the ring buffer keeps the last rows") {
+    auto ring = CostVolume::ringBuffer(4, 3, 1, 3, CostVolume::Layout::ColumnInner, CostVolume::Storage::Float32);
+    for (int row = -2; row < 5; ++row) {
+        ring.set(row, 1, 2, static_cast<float>(row));
+        CHECK(ring.scores(row, 2)[1] == static_cast<float>(row));
+    }
+    for (int row = 2; row < 5; ++row) {
+        CHECK(ring.get(row, 1, 2) == static_cast<float>(row));
+    }
+    CHECK(ring.getBytes() == 4 * 3 * 2 * sizeof(float));
+}
+
+TEST_CASE("check if the half precision conversion rounds to nearest") {
+    CostVolume volume(1, 1, 0, 1, CostVolume::Layout::DisparityInner, CostVolume::Storage::Float16);
+    for (float value : { 0.0f, 1.0f, -2.5f, 0.333251953125f, 65504.0f, 1.0f / 16384, 1.0f / 16777216 }) {
+        volume.set(0, 0, 0, value);
+        CHECK(volume.get(0, 0, 0) == value);
+    }
+    volume.set(0, 0, 0, 1.0f + 1.0f / 4096);
+    CHECK(volume.get(0, 0, 0) == 1.0f);
+    volume.set(0, 0, 0, 1.0f + 3.0f / 4096);
+    CHECK(volume.get(0, 0, 0) == 1.0f + 1.0f / 1024);
+    volume.set(0, 0, 0, 1e6f);
+    CHECK(std::isinf(volume.get(0, 0, 0)));
+}
+#endif
@@ -0,0 +1,110 @@
+#include "CpuFeatures.hpp"
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define DISPARITY_CPUID_MSVC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#define DISPARITY_CPUID_GNU
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+#if defined(DISPARITY_CPUID_MSVC) || defined(DISPARITY_CPUID_GNU)
+
+struct CpuidRegisters {
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+};
+
+
+CpuidRegisters cpuid(unsigned leaf, unsigned subleaf) {
+    CpuidRegisters regs;
+#ifdef DISPARITY_CPUID_MSVC
+    int info[4];
+    __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+    regs.eax = info[0];
+    regs.ebx = info[1];
+    regs.ecx = info[2];
+    regs.edx = info[3];
+#else
+    if (leaf <= __get_cpuid_max(leaf & 0x80000000u, nullptr)) {
+        __cpuid_count(leaf, subleaf, regs.eax, regs.ebx, regs.ecx, regs.edx);
+    }
+#endif
+    return regs;
+}
+
+
+/// Returns the register state components enabled by the operating system (XCR0).
+unsigned long long xgetbv() {
+#ifdef DISPARITY_CPUID_MSVC
+    return _xgetbv(0);
+#else
+    unsigned eax, edx;
+    __asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+
+
+bool hasBit(unsigned reg, int bit) {
+    return (reg >> bit) & 1u;
+}
+
+#endif
+
+}
+
+
+CpuFeatures::Isa CpuFeatures::detect() {
+#if defined(DISPARITY_CPUID_MSVC) || defined(DISPARITY_CPUID_GNU)
+    const auto leaf1 = cpuid(1, 0);
+    const bool osxsave = hasBit(leaf1.ecx, 27);
+    const bool avx = hasBit(leaf1.ecx, 28);
+    const bool fma = hasBit(leaf1.ecx, 12);
+    const bool popcnt = hasBit(leaf1.ecx, 23);
+    // the OS has to save the SSE and AVX registers on context switches, the census kernels count bits by popcnt
+    if (!osxsave || !avx || !popcnt || (xgetbv() & 0x6) != 0x6) {
+        return Isa::Scalar;
+    }
+
+    const auto leaf7 = cpuid(7, 0);
+    const bool avx2 = hasBit(leaf7.ebx, 5);
+    if (!avx2 || !fma) {
+        return Isa::Avx;
+    }
+
+    const bool avx512 = hasBit(leaf7.ebx, 16) && hasBit(leaf7.ebx, 30) && hasBit(leaf7.ebx, 31);
+    // the OS has to save the mask registers and the upper halves of the ZMM registers too
+    if (!avx512 || (xgetbv() & 0xe6) != 0xe6) {
+        return Isa::Avx2;
+    }
+    return Isa::Avx512;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+
+size_t CpuFeatures::l2CacheSize() {
+    const size_t FALLBACK = 256 * 1024;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    const long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (size > 0) {
+        return static_cast<size_t>(size);
+    }
+#endif
+#if defined(DISPARITY_CPUID_MSVC) || defined(DISPARITY_CPUID_GNU)
+    // the extended leaf reports the L2 size in KiB on both Intel and AMD
+    if (cpuid(0x80000000, 0).eax >= 0x80000006) {
+        const unsigned kib = cpuid(0x80000006, 0).ecx >> 16;
+        if (kib != 0) {
+            return static_cast<size_t>(kib) * 1024;
+        }
+    }
+#endif
+    return FALLBACK;
+}
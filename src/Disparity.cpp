@@ -2,74 +2,236 @@
 #include "Pixels.hpp"
 #include "Disparity.hpp"
 #include "PixelCalc.hpp"
+#include "BoxFilter.hpp"
+#include "SimdZncc.hpp"
+#include "Benchmark.hpp"
+#include "IntegerZncc.hpp"
+#include "Pyramid.hpp"
+#include "Sgm.hpp"
+#include "Census.hpp"
+#include "MatchingCost.hpp"
+#include "WindowSweep.hpp"
+#include "CpuFeatures.hpp"
+#include "SubPixel.hpp"
+#include <algorithm>
+#include <cmath>
 #ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "../thirdparty/doctest.h"
 #endif
 
-constexpr int WINDOW = 9;
-constexpr int MAX_D = 260 / 4;
 constexpr int CROSS_TH = 8;
+constexpr int PYRAMID_BAND = 2;
+constexpr Sgm::Penalties SGM_PENALTIES = { 0.1f, 1.0f };
 
 
 namespace {
 
-float windowStd(const PixelCalc& pixelCalc, int cx, int cy) {
-    const float mean = pixelCalc.means().get(cy, cx);
-    float sum = 0.0f;
-    pixelCalc.pixels().enumerateWindow(cx, cy, WINDOW, [&sum, mean](float value) {
-        sum += (value - mean) * (value - mean);
-    });
-    return sqrtf(sum);
+/// Calculates the planes of an image, with an apron large enough for every window the matching reads.
+PixelCalc calculateWithApron(const Pixelsf& pixels, int window, int maxD,
+                             unsigned planes = PixelCalc::StatisticsPlanes) {
+    return PixelCalc::calculatePixelCalc(pixels, window, window / 2 + maxD, planes);
 }
 
 
-float calcZncc(const PixelCalc& pixL, const PixelCalc& pixR, int cx, int cy, int d) {
-    const int D = WINDOW / 2;
-    float sum = 0.0f;
-    for (int row = cy - D; row <= cy + D; ++row) {
-        for (int col = cx - D; col <= cx + D; ++col) {
-            sum += (pixL.pixels().get(row, col) - pixL.means().get(row, col))
-                   * (pixR.pixels().get(row, col - d) - pixR.means().get(row, col - d));
-        }
+/// Chooses the tile rows of the window engine with the `--tiles` option, otherwise returns 0.
+int sweepTile(const Pixelsf& pixels, int window, int maxD, MatchingCost::Kind cost) {
+    if (!CliOptions::getTiles()) {
+        return 0;
     }
-    return sum / windowStd(pixL, cx, cy) / windowStd(pixR, cx - d, cy);
+    const int height = pixels.getHeight();
+    const size_t cacheBytes = CpuFeatures::l2CacheSize();
+    const int tile = WindowSweep::tileRows(pixels.getWidth(), height, window, maxD, cost, cacheBytes);
+    Logger::logTiles(tile, (height + tile - 1) / tile, cacheBytes);
+    return tile;
 }
 
 
-int findBestDisparity(const PixelCalc& pixL, const PixelCalc& pixR, int cx, int cy, bool invertD) {
-    float best_zncc = 0.0f;
-    int best_disp = 0;
-    for (int disp = 0; disp < MAX_D; ++disp) {
-        const float zncc = calcZncc(pixL, pixR, cx, cy, invertD ? -disp : disp);
-        if (zncc > best_zncc) {
-            best_zncc = zncc;
-            best_disp = disp;
-        }
+Pixelsi matchPixels(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int minD, int maxD, bool invertD,
+                    MatchingCost::Kind cost) {
+    const int window = leftCalc.window();
+    switch (CliOptions::getEngine()) {
+        case CliOptions::Engine::BoxFilter:
+            return BoxFilter::calcDepthMap(leftCalc, rightCalc, window, minD, maxD, invertD, cost);
+        case CliOptions::Engine::SimdDisparity:
+            return SimdZncc::calcDepthMapDisparityLanes(leftCalc, rightCalc, window, minD, maxD, invertD);
+        case CliOptions::Engine::SimdRow:
+            if (CliOptions::getWindowCache()) {
+                return SimdZncc::calcDepthMapCachedRowLanes(leftCalc, rightCalc, window, minD, maxD, invertD);
+            }
+            return SimdZncc::calcDepthMapRowLanes(leftCalc, rightCalc, window, minD, maxD, invertD);
+        default:
+            return WindowSweep::calcDepthMap(leftCalc, rightCalc, window, minD, maxD, invertD, cost,
+                                             sweepTile(leftCalc.pixels(), window, maxD, cost));
     }
-    return best_disp;
 }
 
 }   // namespace
 
 
-Pixelsi DisparityAlgorithm::calcDepthMap(const Pixelsf& leftPixels, const Pixelsf& rightPixels, bool invertD) {
-    const auto leftCalc = PixelCalc::calculatePixelCalc(leftPixels, WINDOW);
-    const auto rightCalc = PixelCalc::calculatePixelCalc(rightPixels, WINDOW);
+Pixelsi DisparityAlgorithm::calcDepthMap(const Pixelsf& leftPixels, const Pixelsf& rightPixels,
+                                         const DisparityRange& range, bool invertD) {
+    const int window = CliOptions::getWindow();
+    const auto cost = MatchingCost::parse(CliOptions::getCost());
+    const auto fullSearch = [window, invertD, cost](const Pixelsf& levelLeft, const Pixelsf& levelRight,
+                                                    int minD, int maxD) {
+        if (CliOptions::getEngine() == CliOptions::Engine::Census) {
+            Logger::startProgress("calculating depth map");
+            auto depthmap = Census::calcDepthMap(levelLeft, levelRight, window, minD, maxD, invertD);
+            Logger::endProgress();
+            return depthmap;
+        }
+        unsigned planes = MatchingCost::planes(cost);
+        if (CliOptions::getWindowCache()) {
+            planes |= PixelCalc::WindowCachePlane;
+        }
+        const auto leftCalc = calculateWithApron(levelLeft, window, maxD, planes);
+        const auto rightCalc = calculateWithApron(levelRight, window, maxD, planes);
+
+        Logger::startProgress("calculating depth map");
+        auto depthmap = matchPixels(leftCalc, rightCalc, minD, maxD, invertD, cost);
+        Logger::endProgress();
+        return depthmap;
+    };
+    return Pyramid::calcDepthMap(leftPixels, rightPixels, window, range.min, range.max, CliOptions::getLevels(),
+                                 PYRAMID_BAND, invertD, fullSearch);
+}
+
 
+Pixelsi DisparityAlgorithm::calcDepthMap(const Pixelsb& leftPixels, const Pixelsb& rightPixels,
+                                         const DisparityRange& range, bool invertD) {
     Logger::startProgress("calculating depth map");
-    const auto depthmap = Pixelsf::pixelZip<int>(leftPixels, rightPixels,
-                                         [invertD, &leftCalc, &rightCalc](int row, int col) {
-                                             return findBestDisparity(leftCalc, rightCalc, col, row, invertD);
-                                         });
+    auto depthmap = IntegerZncc::calcDepthMap(leftPixels, rightPixels, CliOptions::getWindow(), range.min, range.max,
+                                              invertD);
+    Logger::endProgress();
+    return depthmap;
+}
+
+
+DepthMaps DisparityAlgorithm::calcDepthMaps(const Pixelsf& leftPixels, const Pixelsf& rightPixels,
+                                            const DisparityRange& range) {
+    const int window = CliOptions::getWindow();
+    if (CliOptions::getStream()) {
+        const int width = leftPixels.getWidth();
+        const int threads = std::max(1, std::min(CliOptions::getThreads(), static_cast<int>(leftPixels.getHeight())));
+        Logger::logStream(width, window + 1, range.max - range.min, threads,
+                          threads * BoxFilter::streamBytes(width, window, range.max - range.min));
+        const auto leftCalc = calculateWithApron(leftPixels, window, range.max);
+        const auto rightCalc = calculateWithApron(rightPixels, window, range.max);
+
+        Logger::startProgress("streaming costs");
+        auto depthmaps = BoxFilter::streamDepthMaps(leftCalc, rightCalc, window, range.min, range.max);
+        Logger::endProgress();
+        return depthmaps;
+    }
+    if (CliOptions::getSgmPaths() != 0) {
+        const int width = leftPixels.getWidth();
+        const int height = leftPixels.getHeight();
+        const int paths = CliOptions::getSgmPaths();
+        Logger::logCostVolume(width, height, range.max - range.min, "fp32",
+                              CostVolume::bytesRequired(width, height, range.max - range.min,
+                                                        CostVolume::Storage::Float32));
+        CostVolume volume(width, height, range.min, range.max, CostVolume::Layout::DisparityInner,
+                          CostVolume::Storage::Float32);
+        Logger::logSgm(paths, Sgm::bytesRequired(volume, paths));
+        const auto leftCalc = calculateWithApron(leftPixels, window, range.max);
+        const auto rightCalc = calculateWithApron(rightPixels, window, range.max);
+
+        Logger::startProgress("calculating cost volume");
+        BoxFilter::calcCostVolume(leftCalc, rightCalc, window, false, volume);
+        Logger::endProgress();
+        Logger::startProgress("aggregating costs");
+        auto depthmaps = Sgm::calcDepthMaps(volume, paths, SGM_PENALTIES);
+        Logger::endProgress();
+        return depthmaps;
+    }
+    if (CliOptions::getCostVolume() != "none") {
+        const int width = leftPixels.getWidth();
+        const int height = leftPixels.getHeight();
+        const auto storage = CostVolume::parseStorage(CliOptions::getCostVolume());
+        const auto layout = CostVolume::parseLayout(CliOptions::getCostLayout());
+        Logger::logCostVolume(width, height, range.max - range.min, CliOptions::getCostVolume().c_str(),
+                              CostVolume::bytesRequired(width, height, range.max - range.min, storage));
+        CostVolume volume(width, height, range.min, range.max, layout, storage);
+        const auto leftCalc = calculateWithApron(leftPixels, window, range.max);
+        const auto rightCalc = calculateWithApron(rightPixels, window, range.max);
+
+        Logger::startProgress("calculating cost volume");
+        BoxFilter::calcCostVolume(leftCalc, rightCalc, window, false, volume);
+        Logger::endProgress();
+        return { volume.bestLeft(), volume.bestRight() };
+    }
+    if (!CliOptions::getJoint()) {
+        return { calcDepthMap(leftPixels, rightPixels, range, false),
+                 calcDepthMap(rightPixels, leftPixels, range, true) };
+    }
+
+    const auto leftCalc = calculateWithApron(leftPixels, window, range.max);
+    const auto rightCalc = calculateWithApron(rightPixels, window, range.max);
+
+    Logger::startProgress("calculating depth maps");
+    auto depthmaps = SimdZncc::calcDepthMapsRowLanes(leftCalc, rightCalc, window, range.min, range.max);
+    Logger::endProgress();
+    return depthmaps;
+}
+
+
+ConfidentDepthMap DisparityAlgorithm::calcConfidentDepthMap(const Pixelsf& leftPixels, const Pixelsf& rightPixels,
+                                                            const DisparityRange& range) {
+    const int window = CliOptions::getWindow();
+    const auto cost = MatchingCost::parse(CliOptions::getCost());
+    const auto leftCalc = calculateWithApron(leftPixels, window, range.max, MatchingCost::planes(cost));
+    const auto rightCalc = calculateWithApron(rightPixels, window, range.max, MatchingCost::planes(cost));
+    const int tile = sweepTile(leftPixels, window, range.max, cost);
+
+    Logger::startProgress("calculating depth map and confidence");
+    auto depthmap = WindowSweep::calcConfidentDepthMap(leftCalc, rightCalc, window, range.min, range.max, false,
+                                                       cost, tile);
     Logger::endProgress();
     return depthmap;
 }
 
 
-Pixelsi DisparityAlgorithm::normalize(const Pixelsi& input) {
+Pixelsf DisparityAlgorithm::refineDepthMap(const Pixelsf& leftPixels, const Pixelsf& rightPixels,
+                                           const Pixelsi& depthMap, const DisparityRange& range, bool invertD) {
+    const int window = CliOptions::getWindow();
+    const auto cost = MatchingCost::parse(CliOptions::getCost());
+    const auto leftCalc = calculateWithApron(leftPixels, window, range.max, MatchingCost::planes(cost));
+    const auto rightCalc = calculateWithApron(rightPixels, window, range.max, MatchingCost::planes(cost));
+
+    Logger::startProgress("refining depth map");
+    auto refined = SubPixel::refine(leftCalc, rightCalc, depthMap, range.min, range.max, invertD, cost,
+                                    SubPixel::parse(CliOptions::getSubPixel()));
+    Logger::endProgress();
+    return refined;
+}
+
+
+DepthMaps DisparityAlgorithm::calcDepthMaps(const Pixelsb& leftPixels, const Pixelsb& rightPixels,
+                                            const DisparityRange& range) {
+    return { calcDepthMap(leftPixels, rightPixels, range, false), calcDepthMap(rightPixels, leftPixels, range, true) };
+}
+
+
+void DisparityAlgorithm::benchmarkKernels(const Pixelsf& leftPixels, const Pixelsf& rightPixels,
+                                          const DisparityRange& range) {
+    Benchmark::runKernels(leftPixels, rightPixels, CliOptions::getWindow(), range.min, range.max);
+}
+
+
+Pixelsi DisparityAlgorithm::normalize(const Pixelsi& input, const DisparityRange& range) {
+    std::vector<int> normalizedData(input.getWidth() * input.getHeight());
+    for (int i = 0; i < input.getData().size(); ++i) {
+        normalizedData[i] = input.getData()[i] * 255 / std::max(range.max - 1, 1);
+    }
+    return Pixelsi(move(normalizedData), input.getWidth(), input.getHeight());
+}
+
+
+Pixelsi DisparityAlgorithm::normalize(const Pixelsf& input, const DisparityRange& range) {
     std::vector<int> normalizedData(input.getWidth() * input.getHeight());
     for (int i = 0; i < input.getData().size(); ++i) {
-        normalizedData[i] = input.getData()[i] * 255 / (MAX_D - 1);
+        const float level = std::round(input.getData()[i] * 255.0f / std::max(range.max - 1, 1));
+        normalizedData[i] = std::max(0, std::min(255, static_cast<int>(level)));
     }
     return Pixelsi(move(normalizedData), input.getWidth(), input.getHeight());
 }
@@ -90,6 +252,30 @@ Pixelsi DisparityAlgorithm::crossCheck(const Pixelsi& in1, const Pixelsi& in2) {
 }
 
 
+Pixelsf DisparityAlgorithm::crossCheck(const Pixelsf& in1, const Pixelsf& in2) {
+    std::vector<float> result(in1.getWidth() * in1.getHeight());
+    for (int i = 0; i < in1.getData().size(); ++i) {
+        const float px1 = in1.getData()[i];
+        const float px2 = in2.getData()[i];
+        if (std::abs(px1 - px2) > CROSS_TH) {
+            result[i] = 0.0f;
+        } else {
+            result[i] = (px1 + px2) / 2.0f;
+        }
+    }
+    return Pixelsf(move(result), in1.getWidth(), in1.getHeight());
+}
+
+
+Pixelsi DisparityAlgorithm::uniquenessCheck(const Pixelsi& in, const Pixelsf& confidence, float ratio) {
+    std::vector<int> result(in.getWidth() * in.getHeight());
+    for (int i = 0; i < in.getData().size(); ++i) {
+        result[i] = confidence.getData()[i] < ratio ? 0 : in.getData()[i];
+    }
+    return Pixelsi(move(result), in.getWidth(), in.getHeight());
+}
+
+
 Pixelsi DisparityAlgorithm::occlusionFill(const Pixelsi& in)
 {
     Logger::startProgress("calculating occlusion fill");
@@ -128,18 +314,323 @@ Pixelsi DisparityAlgorithm::occlusionFill(const Pixelsi& in)
 }
 
 
+
 #ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
-TEST_CASE("check if windowMean is correct") {
-    Pixelsf pw ({77,63,31,29,8,17,72,9,92,43,8,57,83,35,78,71,59,38,39,43,42,22,50,4,56,5,87,86,34,97,95,99,16,0,25,35,23,76,23,45,26,35,90,1,13,39,84,21,94,97,38,98,12,76,58,62,49,22,14,64,80,67,47,94,59,23,68,32,75,100,27,93,70,10,25,93,48,88,78,2,77}, 9, 9);
-    CHECK(windowMean(pw, 4, 4) == doctest::Approx(50.8765).epsilon(0.0001));
-    CHECK(windowMean(pw, 0, 4) == doctest::Approx(54.4691).epsilon(0.0001));
+namespace {
+
+template<typename Tcost>
+int findBestDisparity(Tcost& cost, int window, int cx, int cy, int minD, int maxD, bool invertD, float* terms) {
+    float best_score = Tcost::WORST;
+    int best_disp = minD;
+    for (int disp = minD; disp < maxD; ++disp) {
+        const float score = MatchingCost::windowScore(cost, window, cx, cy, invertD ? -disp : disp, terms);
+        if (score > best_score) {
+            best_score = score;
+            best_disp = disp;
+        }
+    }
+    return best_disp;
 }
-#endif
 
 
-#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
-TEST_CASE("check if windowStd is correct") {
-    Pixelsf pw ({77,63,31,29,8,17,72,9,92,43,8,57,83,35,78,71,59,38,39,43,42,22,50,4,56,5,87,86,34,97,95,99,16,0,25,35,23,76,23,45,26,35,90,1,13,39,84,21,94,97,38,98,12,76,58,62,49,22,14,64,80,67,47,94,59,23,68,32,75,100,27,93,70,10,25,93,48,88,78,2,77}, 9, 9);
-    CHECK(windowStd(pw, 4, 4) == doctest::Approx(271.6298).epsilon(0.0001));
+float calcZncc(const PixelCalc& pixL, const PixelCalc& pixR, int cx, int cy, int d) {
+    MatchingCost::Zncc cost(pixL, pixR, Kernels::active());
+    std::vector<float> terms(pixL.window());
+    return MatchingCost::windowScore(cost, pixL.window(), cx, cy, d, terms.data());
+}
+
+
+int findBestDisparity(const PixelCalc& pixL, const PixelCalc& pixR, int cx, int cy, int minD, int maxD,
+                      bool invertD) {
+    MatchingCost::Zncc cost(pixL, pixR, Kernels::active());
+    std::vector<float> terms(pixL.window());
+    return findBestDisparity(cost, pixL.window(), cx, cy, minD, maxD, invertD, terms.data());
+}
+
+
+/// Evaluates the windows one by one, the reference of `WindowSweep`.
+Pixelsi matchWindows(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int minD, int maxD, bool invertD,
+                     MatchingCost::Kind cost) {
+    const int window = leftCalc.window();
+    const int width = leftCalc.pixels().getWidth();
+    const int height = leftCalc.pixels().getHeight();
+    std::vector<int> result(static_cast<size_t>(width) * height);
+    MatchingCost::dispatch(cost, [&](auto costType) {
+        using Cost = std::remove_pointer_t<decltype(costType)>;
+        Workers::forEachBand(height, [&](int begin, int end) {
+            Cost bandCost(leftCalc, rightCalc, Kernels::active());
+            std::vector<float> terms(window);
+            for (int row = begin; row < end; ++row) {
+                for (int col = 0; col < width; ++col) {
+                    result[row * width + col] = findBestDisparity(bandCost, window, col, row, minD, maxD, invertD,
+                                                                  terms.data());
+                }
+            }
+        });
+    });
+    return Pixelsi(std::move(result), width, height);
+}
+
+}   // namespace
+
+
+TEST_CASE("check if the vectorized engines match the window engine") {
+    const int maxD = 260 / 4;
+    const auto images = shiftedPair(37, 24, 5);
+    const Pixelsf& left = images.first;
+    const Pixelsf& right = images.second;
+
+    // 9 has specialized kernels, 13 runs the generic ones
+    for (int window : { 9, 13 }) {
+        const unsigned planes = PixelCalc::StatisticsPlanes | PixelCalc::WindowCachePlane;
+        const auto leftCalc = calculateWithApron(left, window, maxD, planes);
+        const auto rightCalc = calculateWithApron(right, window, maxD, planes);
+
+        // the second range skips the small disparities, like a calibration file with vmin > 0 does
+        for (const auto range : { DisparityRange{ 0, maxD }, DisparityRange{ 10, 40 } }) {
+            const int minD = range.min;
+            const int endD = range.max;
+            for (bool invertD : { false, true }) {
+                std::vector<Pixelsi> maps;
+                maps.push_back(BoxFilter::calcDepthMap(leftCalc, rightCalc, window, minD, endD, invertD));
+                for (const auto kernels : Kernels::available()) {
+                    maps.push_back(SimdZncc::calcDepthMapDisparityLanes(leftCalc, rightCalc, window, minD, endD,
+                                                                        invertD, *kernels));
+                    maps.push_back(SimdZncc::calcDepthMapRowLanes(leftCalc, rightCalc, window, minD, endD,
+                                                                  invertD, *kernels));
+                    // the cached windows are summed in the same order
+                    const auto cached = SimdZncc::calcDepthMapCachedRowLanes(leftCalc, rightCalc, window, minD, endD,
+                                                                             invertD, *kernels);
+                    CHECK(cached.getData() == maps.back().getData());
+                }
+                for (const auto& map : maps) {
+                    for (int row = 0; row < 24; ++row) {
+                        for (int col = 0; col < 37; ++col) {
+                            // allow different winners only when their scores are equal up to rounding
+                            const int sign = invertD ? -1 : 1;
+                            const int engineD = map.get(row, col);
+                            const int windowD = findBestDisparity(leftCalc, rightCalc, col, row, minD, endD,
+                                                                  invertD);
+                            CHECK(engineD >= minD);
+                            CHECK(engineD < endD);
+                            CHECK(calcZncc(leftCalc, rightCalc, col, row, sign * engineD)
+                                  == doctest::Approx(calcZncc(leftCalc, rightCalc, col, row, sign * windowD))
+                                     .epsilon(0.0001));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("check if the joint search finds the maps of both directions") {
+    const int width = 45, height = 20, window = 9, minD = 4, maxD = 30;
+    const auto images = shiftedPair(width, height, 5);
+    const Pixelsf& left = images.first;
+    const Pixelsf& right = images.second;
+    const auto leftCalc = calculateWithApron(left, window, maxD);
+    const auto rightCalc = calculateWithApron(right, window, maxD);
+
+    for (const auto kernels : Kernels::available()) {
+        const auto maps = SimdZncc::calcDepthMapsRowLanes(leftCalc, rightCalc, window, minD, maxD, *kernels);
+        const auto leftMap = SimdZncc::calcDepthMapRowLanes(leftCalc, rightCalc, window, minD, maxD, false, *kernels);
+        CHECK(maps.left.getData() == leftMap.getData());
+        for (int row = 0; row < height; ++row) {
+            for (int col = 0; col < width; ++col) {
+                // the inverted search, without the pairs outside the left image
+                const int jointD = maps.right.get(row, col);
+                const int windowD = findBestDisparity(rightCalc, leftCalc, col, row, minD,
+                                                      std::max(std::min(maxD, width - col), minD), true);
+                CHECK(jointD >= minD);
+                CHECK(jointD < maxD);
+                CHECK(calcZncc(rightCalc, leftCalc, col, row, -jointD)
+                      == doctest::Approx(calcZncc(rightCalc, leftCalc, col, row, -windowD)).epsilon(0.0001));
+            }
+        }
+    }
+}
+
+TEST_CASE("check if the cost volume gives the maps of the box filter engine") {
+    const int width = 40, height = 16, window = 9, minD = 3, maxD = 20;
+    const auto images = shiftedPair(width, height, 5);
+    const Pixelsf& left = images.first;
+    const Pixelsf& right = images.second;
+    const auto leftCalc = calculateWithApron(left, window, maxD);
+    const auto rightCalc = calculateWithApron(right, window, maxD);
+
+    for (auto layout : { CostVolume::Layout::DisparityInner, CostVolume::Layout::ColumnInner }) {
+        CostVolume volume(width, height, minD, maxD, layout, CostVolume::Storage::Float32);
+        BoxFilter::calcCostVolume(leftCalc, rightCalc, window, false, volume);
+        const auto leftMap = BoxFilter::calcDepthMap(leftCalc, rightCalc, window, minD, maxD, false);
+        CHECK(volume.bestLeft().getData() == leftMap.getData());
+        const auto streamed = BoxFilter::streamDepthMaps(leftCalc, rightCalc, window, minD, maxD);
+        CHECK(streamed.left.getData() == leftMap.getData());
+        CHECK(streamed.right.getData() == volume.bestRight().getData());
+
+        const auto rightMap = volume.bestRight();
+        for (int row = 0; row < height; ++row) {
+            for (int col = 0; col < width; ++col) {
+                const int windowD = findBestDisparity(rightCalc, leftCalc, col, row, minD,
+                                                      std::max(std::min(maxD, width - col), minD), true);
+                CHECK(calcZncc(rightCalc, leftCalc, col, row, -rightMap.get(row, col))
+                      == doctest::Approx(calcZncc(rightCalc, leftCalc, col, row, -windowD)).epsilon(0.0001));
+            }
+        }
+    }
+}
+
+TEST_CASE("check if the window sweep and the box filter engine match the window engine with every cost") {
+    const int width = 48, height = 20, shift = 4, window = 9, minD = 1, maxD = 16;
+    const auto images = shiftedPair(width, height, shift);
+    const Pixelsf& left = images.first;
+    const Pixelsf& right = images.second;
+
+    for (auto cost : { MatchingCost::Kind::Zncc, MatchingCost::Kind::Sad, MatchingCost::Kind::Ssd,
+                       MatchingCost::Kind::Census }) {
+        const auto leftCalc = calculateWithApron(left, window, maxD, MatchingCost::planes(cost));
+        const auto rightCalc = calculateWithApron(right, window, maxD, MatchingCost::planes(cost));
+        for (bool invertD : { false, true }) {
+            const auto& from = invertD ? rightCalc : leftCalc;
+            const auto& to = invertD ? leftCalc : rightCalc;
+            const auto windowMap = matchWindows(from, to, minD, maxD, invertD, cost);
+            const auto sweepMap = WindowSweep::calcDepthMap(from, to, window, minD, maxD, invertD, cost);
+            CHECK(sweepMap.getData() == windowMap.getData());
+            // tiles shorter than the window, the last one is cut short
+            const auto tiledMap = WindowSweep::calcDepthMap(from, to, window, minD, maxD, invertD, cost, 7);
+            CHECK(tiledMap.getData() == windowMap.getData());
+            // the pixel values are integers, so the box filter sums the terms of the differences exactly
+            if (cost != MatchingCost::Kind::Zncc) {
+                const auto boxMap = BoxFilter::calcDepthMap(from, to, window, minD, maxD, invertD, cost);
+                CHECK(boxMap.getData() == windowMap.getData());
+            }
+        }
+        const auto map = BoxFilter::calcDepthMap(leftCalc, rightCalc, window, minD, maxD, false, cost);
+        for (int row = 0; row < height; ++row) {
+            for (int col = shift + window; col < width - window; ++col) {
+                CHECK(map.get(row, col) == shift);
+            }
+        }
+    }
+}
+
+TEST_CASE("check if the uniqueness check keeps the textured pixels and drops the flat ones") {
+    const int width = 48, height = 20, shift = 4, window = 5, minD = 0, maxD = 12, flat = 24;
+    // the columns from flat on are constant, every disparity matches them equally
+    const auto images = shiftedPair(width, height, shift, flat);
+    const Pixelsf& left = images.first;
+    const Pixelsf& right = images.second;
+
+    const auto cost = MatchingCost::Kind::Sad;
+    const auto leftCalc = calculateWithApron(left, window, maxD, MatchingCost::planes(cost));
+    const auto rightCalc = calculateWithApron(right, window, maxD, MatchingCost::planes(cost));
+    const auto map = WindowSweep::calcConfidentDepthMap(leftCalc, rightCalc, window, minD, maxD, false, cost);
+    CHECK(map.disparities.getData()
+          == WindowSweep::calcDepthMap(leftCalc, rightCalc, window, minD, maxD, false, cost).getData());
+
+    const auto checked = DisparityAlgorithm::uniquenessCheck(map.disparities, map.confidence, 0.5f);
+    for (int row = 0; row < height; ++row) {
+        for (int col = shift + window; col < flat - window; ++col) {
+            CHECK(map.confidence.get(row, col) == 1.0f);
+            CHECK(checked.get(row, col) == shift);
+        }
+        for (int col = flat + maxD + window; col < width; ++col) {
+            CHECK(map.confidence.get(row, col) == 0.0f);
+            CHECK(checked.get(row, col) == 0);
+        }
+    }
+}
+
+TEST_CASE("check if the confidence skips the neighbours of the final best disparity") {
+    // smooth waves, the scores fall off slowly on both sides of the match, and hashed noise
+    const int width = 64, height = 12, shift = 4, window = 7, minD = 0, maxD = 10;
+    auto wave = [](int x, int row) {
+        return 100.0f + 60.0f * std::sin(x * 0.3f + row * 0.2f) + 30.0f * std::sin(x * 0.11f);
+    };
+    std::vector<float> leftData(width * height), rightData(width * height);
+    for (int row = 0; row < height; ++row) {
+        for (int col = 0; col < width; ++col) {
+            rightData[row * width + col] = wave(col, row);
+            leftData[row * width + col] = wave(col - shift, row);
+        }
+    }
+    const auto noise = shiftedPair(width, height, shift);
+    std::vector<std::pair<Pixelsf, Pixelsf>> pairs;
+    pairs.emplace_back(Pixelsf(std::move(leftData), width, height), Pixelsf(std::move(rightData), width, height));
+    pairs.push_back(noise);
+
+    for (const auto& images : pairs) {
+        for (auto cost : { MatchingCost::Kind::Zncc, MatchingCost::Kind::Ssd }) {
+            const auto leftCalc = calculateWithApron(images.first, window, maxD, MatchingCost::planes(cost));
+            const auto rightCalc = calculateWithApron(images.second, window, maxD, MatchingCost::planes(cost));
+            const auto map = WindowSweep::calcConfidentDepthMap(leftCalc, rightCalc, window, minD, maxD, false,
+                                                                cost);
+            MatchingCost::dispatch(cost, [&](auto costType) {
+                using Cost = std::remove_pointer_t<decltype(costType)>;
+                Cost reference(leftCalc, rightCalc, Kernels::active());
+                std::vector<float> terms(window);
+                for (int row = 0; row < height; ++row) {
+                    for (int col = 0; col < width; ++col) {
+                        const int bestD = map.disparities.get(row, col);
+                        const float best = MatchingCost::windowScore(reference, window, col, row, bestD,
+                                                                     terms.data());
+                        float second = Cost::WORST;
+                        for (int disp = minD; disp < maxD; ++disp) {
+                            if (std::abs(disp - bestD) > 1) {
+                                second = std::max(second, MatchingCost::windowScore(reference, window, col, row,
+                                                                                    disp, terms.data()));
+                            }
+                        }
+                        const float ratio = (Cost::PERFECT - best) / (Cost::PERFECT - second);
+                        const float expected = Cost::PERFECT - second > 0.0f
+                                               ? std::max(0.0f, std::min(1.0f, 1.0f - ratio)) : 0.0f;
+                        CHECK(map.confidence.get(row, col) == doctest::Approx(expected).epsilon(0.0001));
+                    }
+                }
+            });
+        }
+    }
+    // the wide peaks of the waves are still confident
+    const auto cost = MatchingCost::Kind::Ssd;
+    const auto leftCalc = calculateWithApron(pairs[0].first, window, maxD, MatchingCost::planes(cost));
+    const auto rightCalc = calculateWithApron(pairs[0].second, window, maxD, MatchingCost::planes(cost));
+    const auto map = WindowSweep::calcConfidentDepthMap(leftCalc, rightCalc, window, minD, maxD, false, cost);
+    for (int row = 0; row < height; ++row) {
+        for (int col = maxD + window; col < width - window; ++col) {
+            CHECK(map.disparities.get(row, col) == shift);
+            CHECK(map.confidence.get(row, col) > 0.5f);
+        }
+    }
+}
+
+TEST_CASE("check if the integer engine agrees with the floating point engines") {
+    const int width = 64, height = 32, shift = 3, maxD = 260 / 4;
+    const auto images = shiftedPair<unsigned char>(width, height, shift);
+    const Pixelsb& left = images.first;
+    const Pixelsb& right = images.second;
+    const auto floatImages = shiftedPair(width, height, shift);
+    const Pixelsf& leftFloat = floatImages.first;
+    const Pixelsf& rightFloat = floatImages.second;
+
+    for (int window : { 9, 13 }) {
+        const auto leftCalc = calculateWithApron(leftFloat, window, maxD);
+        const auto rightCalc = calculateWithApron(rightFloat, window, maxD);
+        const auto reference = BoxFilter::calcDepthMap(leftCalc, rightCalc, window, 0, maxD, false);
+
+        for (const auto kernels : Kernels::available()) {
+            // the engines center the windows differently, so only most of the pixels have to agree
+            const auto map = IntegerZncc::calcDepthMap(left, right, window, 0, maxD, false, *kernels);
+            int checked = 0, agreeing = 0, exact = 0;
+            for (int row = 0; row < height; ++row) {
+                for (int col = shift + window; col < width; ++col) {
+                    ++checked;
+                    agreeing += std::abs(map.get(row, col) - reference.get(row, col)) <= 1;
+                    exact += map.get(row, col) == shift;
+                }
+            }
+            CHECK(agreeing >= checked * 95 / 100);
+            CHECK(exact >= checked * 95 / 100);
+        }
+    }
 }
 #endif
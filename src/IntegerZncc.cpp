@@ -0,0 +1,78 @@
+#include <cmath>
+#include "IntegerZncc.hpp"
+#include "IntegralImage.hpp"
+#include "Workers.hpp"
+
+
+namespace {
+
+/// Row-padded copies of the planes read by the integer kernels.
+class BytePlanes {
+public:
+    BytePlanes(const Pixelsb& pixels, int window, int border) :
+        m_pixels    (pixels.getPaddedRows(border)),
+        m_zeros     (pixels.getWidth() + 2 * border, 0),
+        m_border    (border),
+        m_height    (static_cast<int>(pixels.getHeight())),
+        m_stride    (static_cast<int>(pixels.getWidth()) + 2 * border)
+    {
+        const Pixelsf values(std::vector<float>(pixels.getData().begin(), pixels.getData().end()),
+                             pixels.getWidth(), pixels.getHeight());
+        const IntegralImage sums(values, window / 2, false);
+        const IntegralImage squareSums(values, window / 2, true);
+        const double count = window * window;
+
+        std::vector<int> sumData(pixels.getData().size());
+        std::vector<float> invDevData(pixels.getData().size());
+        unsigned index = 0;
+        for (int row = 0; row < pixels.getHeight(); ++row) {
+            for (int col = 0; col < pixels.getWidth(); ++col) {
+                // both sums are exact integers, so a flat window gives exactly 0
+                const double sum = sums.windowSum(col, row, window);
+                const double deviations = count * squareSums.windowSum(col, row, window) - sum * sum;
+                sumData[index] = static_cast<int>(sum);
+                invDevData[index++] = deviations > 0.0 ? static_cast<float>(1.0 / sqrt(deviations)) : 0.0f;
+            }
+        }
+        m_sums = Pixelsi(std::move(sumData), pixels.getWidth(), pixels.getHeight()).getPaddedRows(border);
+        m_invDevs = Pixelsf(std::move(invDevData), pixels.getWidth(), pixels.getHeight()).getPaddedRows(border);
+    }
+
+    Kernels::ByteRows rows() const noexcept {
+        return { &m_pixels[m_border], &m_sums[m_border], &m_invDevs[m_border], &m_zeros[m_border],
+                 m_height, m_stride };
+    }
+
+private:
+    const std::vector<unsigned char> m_pixels;
+    const std::vector<unsigned char> m_zeros;
+    std::vector<int> m_sums;
+    std::vector<float> m_invDevs;
+    const int m_border;
+    const int m_height;
+    const int m_stride;
+};
+
+}
+
+
+Pixelsi IntegerZncc::calcDepthMap(const Pixelsb& leftPixels, const Pixelsb& rightPixels, int window, int minD,
+                                  int maxD, bool invertD, const Kernels::Table& kernels) {
+    const int width = leftPixels.getWidth();
+    const int height = leftPixels.getHeight();
+    // the padding is symmetric, so it covers the overread on the right side too
+    const int border = window / 2 + maxD + Kernels::INTEGER_OVERREAD;
+    const BytePlanes left(leftPixels, window, border);
+    const BytePlanes right(rightPixels, window, border);
+
+    const auto kernel = kernels.matchers(window, invertD).matchRowLanesInteger;
+
+    std::vector<int> result(static_cast<size_t>(width) * height);
+    Workers::forEachBand(height, [&](int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+            kernel(left.rows(), right.rows(), row, width, window, minD, maxD, &result[row * width]);
+        }
+    });
+
+    return Pixelsi(std::move(result), width, height);
+}
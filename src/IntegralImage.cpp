@@ -0,0 +1,33 @@
+#include "IntegralImage.hpp"
+#include "Kernels.hpp"
+
+
+IntegralImage::IntegralImage(const Pixelsf& pixels, int border, bool squared) :
+    m_border    (border),
+    m_stride    (static_cast<int>(pixels.getWidth()) + 2 * border + 1)
+{
+    const int width = m_stride - 1;
+    const int height = static_cast<int>(pixels.getHeight()) + 2 * border;
+    m_data.resize(static_cast<size_t>(m_stride) * (height + 1));
+
+    // the first row and column of the table stays zero, the rows are summed horizontally in parallel
+    Workers::forEachBand(height, [&](int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+            double rowSum = 0.0;
+            double* tableRow = &m_data[(row + 1) * m_stride + 1];
+            for (int col = 0; col < width; ++col) {
+                const double value = pixels.get(row - border, col - border);
+                rowSum += squared ? value * value : value;
+                tableRow[col] = rowSum;
+            }
+        }
+    });
+    // then every band of columns vertically, adding the rows in the same order as a single pass
+    const auto& kernels = Kernels::active();
+    Workers::forEachBand(width, [&](int begin, int end) {
+        for (int row = 1; row < height; ++row) {
+            kernels.accumulateRows(&m_data[row * m_stride + 1 + begin], &m_data[(row + 1) * m_stride + 1 + begin],
+                                   end - begin);
+        }
+    });
+}
@@ -0,0 +1,68 @@
+#include <exception>
+#include "Kernels.hpp"
+#include "CliOptions.hpp"
+
+
+namespace KernelsScalar { extern const Kernels::Table TABLE; }
+#ifdef DISPARITY_X86_KERNELS
+namespace KernelsAvx { extern const Kernels::Table TABLE; }
+namespace KernelsAvx2 { extern const Kernels::Table TABLE; }
+namespace KernelsAvx512 { extern const Kernels::Table TABLE; }
+#endif
+
+
+namespace {
+
+const Kernels::Table* const VARIANTS[] = {
+        &KernelsScalar::TABLE,
+#ifdef DISPARITY_X86_KERNELS
+        &KernelsAvx::TABLE,
+        &KernelsAvx2::TABLE,
+        &KernelsAvx512::TABLE,
+#endif
+};
+
+
+const Kernels::Table& selectVariant() {
+    const auto supported = Kernels::available();
+    const auto& requested = CliOptions::getIsa();
+    if (requested == "auto") {
+        return *supported.back();
+    }
+    for (const auto table : supported) {
+        if (requested == table->name) {
+            return *table;
+        }
+    }
+    throw std::exception();
+}
+
+}
+
+
+const Kernels::Table& Kernels::active() {
+    static const Table& table = selectVariant();
+    return table;
+}
+
+
+bool Kernels::isSpecialized(int window) {
+    for (const int size : SPECIALIZED_WINDOWS) {
+        if (size == window) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+std::vector<const Kernels::Table*> Kernels::available() {
+    const auto isa = CpuFeatures::detect();
+    std::vector<const Table*> result;
+    for (const auto table : VARIANTS) {
+        if (table->isa <= isa) {
+            result.push_back(table);
+        }
+    }
+    return result;
+}
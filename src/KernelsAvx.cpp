@@ -0,0 +1,26 @@
+#include <cmath>
+#include "immintrin.h"
+#include "Kernels.hpp"
+
+
+namespace KernelsAvx {
+
+#include "KernelVecAvx.hpp"
+#include "KernelsImpl.hpp"
+
+extern const Kernels::Table TABLE = {
+        "avx",
+        CpuFeatures::Isa::Avx,
+        downsampleGrey,
+        downsampleGrey8,
+        accumulateRows,
+        windowStatistics,
+        sgmStep,
+        hammingDistances,
+        products,
+        absDifferences,
+        squaredDifferences,
+        matchers,
+};
+
+}   // namespace KernelsAvx
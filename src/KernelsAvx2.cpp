@@ -0,0 +1,26 @@
+#include <cmath>
+#include "immintrin.h"
+#include "Kernels.hpp"
+
+
+namespace KernelsAvx2 {
+
+#include "KernelVecAvx.hpp"
+#include "KernelsImpl.hpp"
+
+extern const Kernels::Table TABLE = {
+        "avx2",
+        CpuFeatures::Isa::Avx2,
+        downsampleGrey,
+        downsampleGrey8,
+        accumulateRows,
+        windowStatistics,
+        sgmStep,
+        hammingDistances,
+        products,
+        absDifferences,
+        squaredDifferences,
+        matchers,
+};
+
+}   // namespace KernelsAvx2
@@ -0,0 +1,26 @@
+#include <cmath>
+#include "immintrin.h"
+#include "Kernels.hpp"
+
+
+namespace KernelsAvx512 {
+
+#include "KernelVecAvx512.hpp"
+#include "KernelsImpl.hpp"
+
+extern const Kernels::Table TABLE = {
+        "avx512",
+        CpuFeatures::Isa::Avx512,
+        downsampleGrey,
+        downsampleGrey8,
+        accumulateRows,
+        windowStatistics,
+        sgmStep,
+        hammingDistances,
+        products,
+        absDifferences,
+        squaredDifferences,
+        matchers,
+};
+
+}   // namespace KernelsAvx512
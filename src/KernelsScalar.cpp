@@ -0,0 +1,25 @@
+#include <cmath>
+#include "Kernels.hpp"
+
+
+namespace KernelsScalar {
+
+#include "KernelVecScalar.hpp"
+#include "KernelsImpl.hpp"
+
+extern const Kernels::Table TABLE = {
+        "scalar",
+        CpuFeatures::Isa::Scalar,
+        downsampleGrey,
+        downsampleGrey8,
+        accumulateRows,
+        windowStatistics,
+        sgmStep,
+        hammingDistances,
+        products,
+        absDifferences,
+        squaredDifferences,
+        matchers,
+};
+
+}   // namespace KernelsScalar
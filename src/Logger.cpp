@@ -2,6 +2,7 @@
 #include <iostream>
 #include "../thirdparty/lodepng.h"
 #include "CliOptions.hpp"
+#include "Kernels.hpp"
 
 
 int Logger::m_lastBars = 0;
@@ -13,7 +14,20 @@ void Logger::logInit() {
     std::cout <<
         "Disparity algorithm CPU implementation started." << std::endl <<
         "Number of worker threads = " << CliOptions::getThreads() << std::endl <<
-        "Window size = " << CliOptions::getWindow() << std::endl;
+        "Window size = " << CliOptions::getWindow() <<
+            (Kernels::isSpecialized(CliOptions::getWindow()) ? " (specialized kernels)" : " (generic kernels)") << std::endl <<
+        "Downscale factor = " << CliOptions::getDownscale() << std::endl <<
+        "Pyramid levels = " << CliOptions::getLevels() << std::endl <<
+        "Matching engine = " << CliOptions::getEngineName() <<
+            (CliOptions::getWindowCache() ? " (from the window cache)" : "") << std::endl <<
+        "Matching cost = " << CliOptions::getCost() << std::endl <<
+        "Sub-pixel refinement = " << CliOptions::getSubPixel() << std::endl <<
+        "Right depth map = " << (CliOptions::getUniqueness() > 0.0f ? "skipped, uniqueness check instead"
+                                 : CliOptions::getStream() ? "from the streamed costs"
+                                 : CliOptions::getSgmPaths() != 0 ? "from the aggregated costs"
+                                 : CliOptions::getCostVolume() != "none" ? "from the cost volume"
+                                 : CliOptions::getJoint() ? "from the left scores" : "matched separately") << std::endl <<
+        "Kernel variant = " << Kernels::active().name << std::endl;
 }
 
 
@@ -35,6 +49,40 @@ void Logger::logSave(unsigned code, const char *filename) {
 }
 
 
+void Logger::logCalibration(const char *filename, bool loaded, int minD, int maxD) {
+    if (loaded) {
+        std::cout << "loading '" << filename << "' was successful";
+    } else {
+        std::cout << "'" << filename << "' not found, using the default range";
+    }
+    std::cout << ", searching disparities " << minD << "-" << maxD - 1 << std::endl;
+}
+
+
+void Logger::logCostVolume(int width, int height, int disparities, const char* storage, size_t bytes) {
+    std::cout << "cost volume " << width << "x" << height << "x" << disparities << " " << storage
+              << " needs " << bytes / (1024.0 * 1024.0) << " MiB" << std::endl;
+}
+
+
+void Logger::logStream(int width, int rows, int disparities, int threads, size_t bytes) {
+    std::cout << "cost ring buffer " << width << "x" << rows << "x" << disparities << " fp32 on " << threads
+              << " threads needs " << bytes / (1024.0 * 1024.0) << " MiB" << std::endl;
+}
+
+
+void Logger::logSgm(int paths, size_t bytes) {
+    std::cout << "semi-global matching on " << paths << " paths needs " << bytes / (1024.0 * 1024.0)
+              << " MiB" << std::endl;
+}
+
+
+void Logger::logTiles(int tileRows, int tiles, size_t cacheBytes) {
+    std::cout << "tiles of " << tileRows << " rows, " << tiles << " tiles for " << cacheBytes / 1024
+              << " KiB of L2 cache" << std::endl;
+}
+
+
 void Logger::startProgress(const char* text) {
     m_progressText = text;
     std::cout << "=== starting " << text << std::endl;
@@ -66,6 +114,12 @@ void Logger::logProgress(float percent) {
 }
 
 
+void Logger::logBenchmark(const char* kernel, const char* variant, float seconds, float speedup,
+                          const char* baseline) {
+    std::cout << kernel << " [" << variant << "]\t" << seconds << "s\t" << speedup << "x of " << baseline << std::endl;
+}
+
+
 void Logger::endProgress() {
     std::chrono::duration<float> elapsed = std::chrono::system_clock::now() - m_startTime;
     m_lastBars = 0;
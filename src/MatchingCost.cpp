@@ -0,0 +1,34 @@
+#include <map>
+#include "MatchingCost.hpp"
+
+
+constexpr float MatchingCost::Zncc::WORST;
+constexpr float MatchingCost::Sad::WORST;
+constexpr float MatchingCost::Ssd::WORST;
+constexpr float MatchingCost::Census::WORST;
+constexpr float MatchingCost::Zncc::PERFECT;
+constexpr float MatchingCost::Sad::PERFECT;
+constexpr float MatchingCost::Ssd::PERFECT;
+constexpr float MatchingCost::Census::PERFECT;
+
+
+MatchingCost::Kind MatchingCost::parse(const std::string& name) {
+    const std::map<std::string, Kind> KINDS = {
+            { "zncc",   Kind::Zncc },
+            { "sad",    Kind::Sad },
+            { "ssd",    Kind::Ssd },
+            { "census", Kind::Census },
+    };
+    const auto it = KINDS.find(name);
+    if (it == KINDS.end()) {
+        throw std::exception();
+    }
+    return it->second;
+}
+
+
+unsigned MatchingCost::planes(Kind kind) {
+    return dispatch(kind, [](auto cost) {
+        return std::remove_pointer_t<decltype(cost)>::PLANES;
+    });
+}
@@ -0,0 +1,117 @@
+#include <cstdlib>
+#include <algorithm>
+#include "Memory.hpp"
+#include "CliOptions.hpp"
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "../thirdparty/doctest.h"
+#endif
+
+
+namespace {
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+}
+
+
+void* Memory::allocate(size_t bytes) {
+    const bool huge = CliOptions::getHugePages() && bytes >= HUGE_PAGE;
+    const size_t alignment = huge ? HUGE_PAGE : CACHE_LINE;
+    bytes = roundUp(std::max<size_t>(bytes, 1), alignment);
+    void* data = nullptr;
+#ifdef _MSC_VER
+    data = _aligned_malloc(bytes, alignment);
+#else
+    if (posix_memalign(&data, alignment, bytes) != 0) {
+        data = nullptr;
+    }
+#endif
+    if (!data) {
+        throw std::bad_alloc();
+    }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (huge) {
+        // only a hint, the block stays usable if transparent huge pages are disabled
+        madvise(data, bytes, MADV_HUGEPAGE);
+    }
+#endif
+    return data;
+}
+
+
+void Memory::release(void* data) noexcept {
+#ifdef _MSC_VER
+    _aligned_free(data);
+#else
+    free(data);
+#endif
+}
+
+
+Memory::Arena::~Arena() {
+    for (void* chunk : m_chunks) {
+        release(chunk);
+    }
+}
+
+
+void Memory::Arena::reset() {
+    if (m_chunks.size() > 1) {
+        for (void* chunk : m_chunks) {
+            release(chunk);
+        }
+        m_chunks.clear();
+        m_capacity = roundUp(m_total, CACHE_LINE);
+        m_chunks.push_back(Memory::allocate(m_capacity));
+    }
+    m_used = 0;
+    m_total = 0;
+}
+
+
+void* Memory::Arena::allocateBytes(size_t bytes) {
+    bytes = roundUp(std::max<size_t>(bytes, 1), CACHE_LINE);
+    m_total += bytes;
+    if (m_chunks.empty() || m_used + bytes > m_capacity) {
+        m_capacity = std::max(bytes, 2 * m_capacity);
+        m_chunks.push_back(Memory::allocate(m_capacity));
+        m_used = 0;
+    }
+    void* data = static_cast<char*>(m_chunks.back()) + m_used;
+    m_used += bytes;
+    return data;
+}
+
+
+Memory::Arena& Memory::jobArena() {
+    static Arena arena;
+    return arena;
+}
+
+
+
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+TEST_CASE("check if the arena reuses a single chunk after a reset") {
+    Memory::Arena arena;
+    for (int job = 0; job < 3; ++job) {
+        std::vector<char*> blocks;
+        for (int i = 0; i < 10; ++i) {
+            blocks.push_back(arena.allocate<char>(1000 + i));
+            CHECK(reinterpret_cast<uintptr_t>(blocks.back()) % Memory::CACHE_LINE == 0);
+        }
+        // after the first job every block comes from the chunk of the previous one, in the same order
+        for (int i = 1; i < 10 && job > 0; ++i) {
+            CHECK(blocks[i] - blocks[i - 1] == 1024);
+        }
+        arena.reset();
+    }
+}
+#endif
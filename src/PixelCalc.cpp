@@ -1,71 +1,170 @@
+#include <algorithm>
+#include <string>
 #include "PixelCalc.hpp"
 #include "Logger.hpp"
+#include "Kernels.hpp"
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "../thirdparty/doctest.h"
+#endif
 
 
 namespace {
 
-float windowMean(const Pixelsf& pixels, int cx, int cy, int window) {
-    float sum = 0.0f;
-    pixels.enumerateWindow(cx, cy, window, [&sum](float value) {
-        sum += value;
+/// Copies the rows of a plane straight into the layout of an extended copy, see `Pixels::paddedOrigin`.
+template<typename T>
+Memory::AlignedVector<T> paddedCopy(const Pixels<T>& plane, int apron) {
+    const unsigned width = plane.getWidth();
+    const unsigned height = plane.getHeight();
+    const int stride = Pixels<T>::paddedStride(width, apron);
+    const size_t origin = Pixels<T>::paddedOrigin(width, apron);
+    Memory::AlignedVector<T> padded(Pixels<T>::paddedSize(width, height, apron));
+    Workers::forEachBand(height, [&](int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+            std::copy_n(&plane.getData()[static_cast<size_t>(row) * width], width, &padded[origin + row * stride]);
+        }
     });
-    return sum / static_cast<float>(window * window);
+    return padded;
 }
 
-
-float windowMeanVector(const std::vector<Float8>& windowData, int window) {
-    __m256 sum = _mm256_set1_ps(0);
-    for (const auto& float8 : windowData) {
-        sum = _mm256_add_ps(sum, float8.toVec());
-    }
-    std::array<float, 8> result;
-    _mm256_store_ps(&result[0], sum);
-    float sumf = 0.f;
-    for (auto f : result) {
-        sumf += f;
-    }
-    return sumf / window / window;
 }
 
 
-std::vector<Float8> createWindowCache(const Pixelsf& pixels, int cx, int cy, int window) {
-    const auto windowCacheSize = static_cast<unsigned>(((window * window / 8) + 1) * 8);
-    const auto windowData = pixels.getWindowData(cx, cy, window, windowCacheSize);
-    std::vector<Float8> windowCache(windowCacheSize / 8);
-    for (int i = 0; i < windowCache.size(); ++i) {
-        windowCache[i] = Float8(&windowData[i * 8]);
-    }
-    return windowCache;
-}
-
+float PixelCalc::windowMean(int cx, int cy) const {
+    return static_cast<float>(m_sums->windowSum(cx, cy, m_window) / (m_window * m_window));
 }
 
 
-const std::vector<Float8>& PixelCalc::getWindowData(int cx, int cy) const {
-    return m_windowCache[cy * m_pixels.getWidth() + cx];
+float PixelCalc::windowVariance(int cx, int cy) const {
+    const double count = m_window * m_window;
+    const double mean = m_sums->windowSum(cx, cy, m_window) / count;
+    const double variance = m_squareSums->windowSum(cx, cy, m_window) / count - mean * mean;
+    return static_cast<float>(std::max(variance, 0.0));
 }
 
 
-PixelCalc PixelCalc::calculatePixelCalc(const Pixelsf& pixels, int window) {
-    PixelCalc calc(pixels);
-    std::vector<float> meanData(pixels.getData().size());
+PixelCalc PixelCalc::calculatePixelCalc(const Pixelsf& pixels, int window, int apron, unsigned planes) {
+    if ((planes & WindowCachePlane) && !(planes & StatisticsPlanes)) {
+        throw std::exception();
+    }
+    PixelCalc calc(pixels, window, apron);
+    const int width = pixels.getWidth();
+    const int height = pixels.getHeight();
 
-    Logger::startProgress("common data calculation (mean, windows)");
-    unsigned index = 0;
-    for (int row = 0; row < pixels.getHeight(); ++row) {
-        for (int col = 0; col < pixels.getWidth(); ++col) {
-            meanData[index] = windowMean(pixels, col, row, window);
-            calc.m_windowCache[index++] = createWindowCache(pixels, col, row, window);
+    // the logger keeps the text until endProgress
+    std::string label;
+    for (const auto& name : { std::make_pair(StatisticsPlanes, "mean, std, centered"),
+                              std::make_pair(PaddedPlane, "padded"),
+                              std::make_pair(CensusPlanes, "census"),
+                              std::make_pair(WindowCachePlane, "windows") }) {
+        if (planes & name.first) {
+            label += (label.empty() ? "" : ", ") + std::string(name.second);
         }
     }
+    label = "common data calculation (" + label + ")";
+    Logger::startProgress(label.c_str());
+    if (planes & StatisticsPlanes) {
+        calc.m_sums = std::make_unique<IntegralImage>(pixels, window / 2, false);
+        calc.m_squareSums = std::make_unique<IntegralImage>(pixels, window / 2, true);
+        // the kernel writes the rows straight into the extended copies, the apron is filled around them
+        const int stride = Pixelsf::paddedStride(width, apron);
+        const size_t origin = Pixelsf::paddedOrigin(width, apron);
+        Memory::AlignedVector<float> meanData(Pixelsf::paddedSize(width, height, apron));
+        Memory::AlignedVector<float> invStdData(meanData.size());
+        Memory::AlignedVector<float> centeredData(meanData.size());
+        const auto& kernels = Kernels::active();
+        Workers::forEachBand(height, [&](int begin, int end) {
+            for (int row = begin; row < end; ++row) {
+                const size_t offset = origin + static_cast<size_t>(row) * stride;
+                kernels.windowStatistics(calc.m_sums->windowTopRow(row, window),
+                                         calc.m_sums->windowBottomRow(row, window),
+                                         calc.m_squareSums->windowTopRow(row, window),
+                                         calc.m_squareSums->windowBottomRow(row, window),
+                                         &pixels.getData()[row * width], width, window,
+                                         &meanData[offset], &centeredData[offset], &invStdData[offset]);
+            }
+        });
+        calc.m_means = std::make_unique<Pixelsf>(width, height, apron, std::move(meanData));
+        calc.m_invStds = std::make_unique<Pixelsf>(width, height, apron, std::move(invStdData));
+        calc.m_centered = std::make_unique<Pixelsf>(width, height, apron, std::move(centeredData));
+    }
+    if (planes & PaddedPlane) {
+        calc.m_padded = std::make_unique<Pixelsf>(width, height, apron, paddedCopy(pixels, apron));
+    }
+    if (planes & CensusPlanes) {
+        for (const auto& plane : Census::transform(pixels, window)) {
+            calc.m_census.emplace_back(width, height, apron, paddedCopy(plane, apron));
+        }
+    }
+    if (planes & WindowCachePlane) {
+        calc.m_windowCache = std::make_unique<WindowCache>(*calc.m_centered, window, apron, Memory::jobArena());
+    }
     Logger::endProgress();
-    calc.m_means = std::make_unique<Pixelsf>(std::move(meanData), pixels.getWidth(), pixels.getHeight());
     return calc;
 }
 
 
-PixelCalc::PixelCalc(const Pixelsf& pixels) noexcept :
+PixelCalc::PixelCalc(const Pixelsf& pixels, int window, int apron) :
     m_pixels        (pixels),
-    m_windowCache   (pixels.getData().size())
+    m_window        (window),
+    m_apron         (apron)
 {
 }
+
+
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+TEST_CASE("check if windowMean is correct") {
+    Pixelsf pw ({77,63,31,29,8,17,72,9,92,43,8,57,83,35,78,71,59,38,39,43,42,22,50,4,56,5,87,86,34,97,95,99,16,0,25,35,23,76,23,45,26,35,90,1,13,39,84,21,94,97,38,98,12,76,58,62,49,22,14,64,80,67,47,94,59,23,68,32,75,100,27,93,70,10,25,93,48,88,78,2,77}, 9, 9);
+    const auto calc = PixelCalc::calculatePixelCalc(pw, 9);
+    CHECK(calc.windowMean(4, 4) == doctest::Approx(50.8765).epsilon(0.0001));
+    CHECK(calc.windowMean(0, 4) == doctest::Approx(54.4691).epsilon(0.0001));
+    CHECK(calc.means().get(4, 0) == doctest::Approx(54.4691).epsilon(0.0001));
+}
+
+
+TEST_CASE("check if windowVariance matches the brute force variance") {
+    Pixelsf pw ({77,63,31,29,8,17,72,9,92,43,8,57,83,35,78,71,59,38,39,43,42,22,50,4,56,5,87,86,34,97,95,99,16,0,25,35,23,76,23,45,26,35,90,1,13,39,84,21,94,97,38,98,12,76,58,62,49,22,14,64,80,67,47,94,59,23,68,32,75,100,27,93,70,10,25,93,48,88,78,2,77}, 9, 9);
+    const auto calc = PixelCalc::calculatePixelCalc(pw, 5);
+    for (int row = 0; row < 9; ++row) {
+        for (int col = 0; col < 9; ++col) {
+            const float mean = calc.windowMean(col, row);
+            float sum = 0.0f;
+            pw.enumerateWindow(col, row, 5, [&sum, mean](float value) {
+                sum += (value - mean) * (value - mean);
+            });
+            CHECK(calc.windowVariance(col, row) == doctest::Approx(sum / 25).epsilon(0.0001));
+        }
+    }
+}
+
+
+TEST_CASE("check if invStds is correct") {
+    Pixelsf pw ({77,63,31,29,8,17,72,9,92,43,8,57,83,35,78,71,59,38,39,43,42,22,50,4,56,5,87,86,34,97,95,99,16,0,25,35,23,76,23,45,26,35,90,1,13,39,84,21,94,97,38,98,12,76,58,62,49,22,14,64,80,67,47,94,59,23,68,32,75,100,27,93,70,10,25,93,48,88,78,2,77}, 9, 9);
+    const auto calc = PixelCalc::calculatePixelCalc(pw, 9);
+    CHECK(calc.invStds().get(4, 4) == doctest::Approx(1.0 / 271.6298).epsilon(0.0001));
+
+    Pixelsf flat (std::vector<float>(81, 42.0f), 9, 9);
+    const auto flatCalc = PixelCalc::calculatePixelCalc(flat, 9);
+    CHECK(flatCalc.invStds().get(4, 4) == 0.0f);
+}
+
+
+TEST_CASE("check if the window cache holds the centered windows of every pixel") {
+    Pixelsf pw ({77,63,31,29,8,17,72,9,92,43,8,57,83,35,78,71,59,38,39,43,42,22,50,4,56,5,87,86,34,97,95,99,16,0,25,35,23,76,23,45,26,35,90,1,13,39,84,21,94,97,38,98,12,76,58,62,49,22,14,64,80,67,47,94,59,23,68,32,75,100,27,93,70,10,25,93,48,88,78,2,77}, 9, 9);
+    const auto calc = PixelCalc::calculatePixelCalc(pw, 5, 3,
+                                                    PixelCalc::StatisticsPlanes | PixelCalc::WindowCachePlane);
+    const auto& cache = calc.windowCache();
+    CHECK(cache.stride() % (WindowCache::ALIGNMENT / sizeof(float)) == 0);
+    for (int element = 0; element < 25; ++element) {
+        CHECK(reinterpret_cast<uintptr_t>(cache.plane(element)) % WindowCache::ALIGNMENT == 0);
+    }
+    for (int row = 0; row < 9; ++row) {
+        for (int col = -3; col < 12; ++col) {
+            const auto window = calc.centered().getWindowData(col, row, 5);
+            for (int element = 0; element < 25; ++element) {
+                CHECK(cache.get(element, row, col) == window[element]);
+            }
+        }
+    }
+    CHECK_THROWS(PixelCalc::calculatePixelCalc(pw, 5, 3, PixelCalc::WindowCachePlane));
+}
+#endif
@@ -4,31 +4,23 @@
 #include <iostream>
 #include "Logger.hpp"
 #include "PixelUtils.hpp"
+#include "Kernels.hpp"
 #include "../thirdparty/lodepng.h"
 
 
 namespace {
 
-Pixelsf preprocessPixels(const std::vector<unsigned char> &pixels, unsigned width, unsigned height) {
-    const float
-            R = 0.2126f,
-            G = 0.7152f,
-            B = 0.0722f;
+Pixelsf preprocessPixels(const std::vector<unsigned char> &pixels, unsigned width, unsigned height, int factor) {
+    std::vector<float> resized((width / factor) * (height / factor));
+    Kernels::active().downsampleGrey(pixels.data(), width, height, factor, resized.data());
+    return Pixelsf(std::move(resized), width / factor, height / factor);
+}
 
-    unsigned index = 0;
-    std::vector<float> resized(pixels.size() / 16 / 3);
-    for (unsigned row = 0; row < height; row += 4) {
-        for (unsigned col = 0; col < width; col += 4) {
-            const unsigned char
-                    r = pixels[(row * width + col) * 3],
-                    g = pixels[(row * width + col) * 3 + 1],
-                    b = pixels[(row * width + col) * 3 + 2];
-            resized[index++] = r * R + g * G + b * B;
-        }
-    }
-    width /= 4;
-    height /= 4;
-    return Pixelsf(std::move(resized), width, height);
+
+Pixelsb preprocessPixels8(const std::vector<unsigned char> &pixels, unsigned width, unsigned height, int factor) {
+    std::vector<unsigned char> resized((width / factor) * (height / factor));
+    Kernels::active().downsampleGrey8(pixels.data(), width, height, factor, resized.data());
+    return Pixelsb(std::move(resized), width / factor, height / factor);
 }
 
 
@@ -45,12 +37,21 @@ std::vector<T> convertPixels(const std::vector<U>& in) {
 }
 
 
-Pixelsf PixelUtils::loadGrey(const char *filename) {
+Pixelsf PixelUtils::loadGrey(const char *filename, int factor) {
+    unsigned width, height;
+    std::vector<unsigned char> pixels;
+    unsigned error = lodepng::decode(pixels, width, height, filename, LCT_RGB);
+    Logger::logLoad(error, filename);
+    return preprocessPixels(pixels, width, height, factor);
+}
+
+
+Pixelsb PixelUtils::loadGrey8(const char *filename, int factor) {
     unsigned width, height;
     std::vector<unsigned char> pixels;
     unsigned error = lodepng::decode(pixels, width, height, filename, LCT_RGB);
     Logger::logLoad(error, filename);
-    return preprocessPixels(pixels, width, height);
+    return preprocessPixels8(pixels, width, height, factor);
 }
 
 
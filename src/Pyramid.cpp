@@ -0,0 +1,108 @@
+#include "Pyramid.hpp"
+#include "PixelCalc.hpp"
+#include "Logger.hpp"
+#include "Workers.hpp"
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "../thirdparty/doctest.h"
+#endif
+
+
+namespace {
+
+/// Scales the disparities of the level above to the size of this level.
+std::vector<int> upsampleDisparities(const Pixelsi& coarse, int width, int height, int minD, int maxD) {
+    std::vector<int> predicted(static_cast<size_t>(width) * height);
+    for (int row = 0; row < height; ++row) {
+        for (int col = 0; col < width; ++col) {
+            predicted[row * width + col] = std::min(std::max(2 * coarse.get(row / 2, col / 2), minD), maxD - 1);
+        }
+    }
+    return predicted;
+}
+
+
+Pixelsi refine(const Pixelsf& leftPixels, const Pixelsf& rightPixels, const Pixelsi& coarse, int window, int minD,
+               int maxD, int band, bool invertD, const Kernels::Table& kernels) {
+    const int width = leftPixels.getWidth();
+    const int height = leftPixels.getHeight();
+    const auto predicted = upsampleDisparities(coarse, width, height, minD, maxD);
+    const auto leftCalc = PixelCalc::calculatePixelCalc(leftPixels, window, window / 2 + maxD,
+                                                        PixelCalc::StatisticsPlanes);
+    const auto rightCalc = PixelCalc::calculatePixelCalc(rightPixels, window, window / 2 + maxD,
+                                                         PixelCalc::StatisticsPlanes);
+    const Kernels::PlaneRows left = { leftCalc.centered().getRow(0), leftCalc.invStds().getRow(0), height,
+                                      leftCalc.centered().getStride() };
+    const Kernels::PlaneRows right = { rightCalc.centered().getRow(0), rightCalc.invStds().getRow(0), height,
+                                       rightCalc.centered().getStride() };
+    const auto kernel = kernels.matchers(window, invertD).matchDisparityBand;
+
+    Logger::startProgress("refining depth map");
+    std::vector<int> result(static_cast<size_t>(width) * height);
+    Workers::forEachBand(height, [&](int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+            kernel(left, right, row, width, window, minD, maxD, &predicted[row * width], band, &result[row * width]);
+        }
+    });
+    Logger::endProgress();
+
+    return Pixelsi(std::move(result), width, height);
+}
+
+}
+
+
+Pixelsf Pyramid::downsample(const Pixelsf& pixels) {
+    const int width = pixels.getWidth() / 2;
+    const int height = pixels.getHeight() / 2;
+    std::vector<float> result(static_cast<size_t>(width) * height);
+    for (int row = 0; row < height; ++row) {
+        for (int col = 0; col < width; ++col) {
+            result[row * width + col] = (pixels.get(2 * row, 2 * col) + pixels.get(2 * row, 2 * col + 1)
+                                         + pixels.get(2 * row + 1, 2 * col) + pixels.get(2 * row + 1, 2 * col + 1))
+                                        * 0.25f;
+        }
+    }
+    return Pixelsf(std::move(result), width, height);
+}
+
+
+Pixelsi Pyramid::calcDepthMap(const Pixelsf& leftPixels, const Pixelsf& rightPixels, int window, int minD,
+                              int maxD, int levels, int band, bool invertD, const FullSearch& fullSearch,
+                              const Kernels::Table& kernels) {
+    const auto smallerSide = std::min(leftPixels.getWidth(), leftPixels.getHeight());
+    if (levels <= 1 || smallerSide / 2 < window) {
+        return fullSearch(leftPixels, rightPixels, minD, maxD);
+    }
+
+    const auto coarse = calcDepthMap(downsample(leftPixels), downsample(rightPixels), window, minD / 2,
+                                     (maxD + 1) / 2, levels - 1, band, invertD, fullSearch, kernels);
+    return refine(leftPixels, rightPixels, coarse, window, minD, maxD, band, invertD, kernels);
+}
+
+
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+TEST_CASE("check if the pyramid finds a constant shift") {
+    const int width = 96, height = 64, shift = 12, window = 9;
+    const auto images = shiftedPair(width, height, shift);
+    const Pixelsf& left = images.first;
+    const Pixelsf& right = images.second;
+
+    int fullSearches = 0;
+    const Pyramid::FullSearch fullSearch = [&](const Pixelsf& l, const Pixelsf& r, int minD, int maxD) {
+        ++fullSearches;
+        CHECK(l.getWidth() == width / 4);
+        CHECK(minD == 2);
+        CHECK(maxD == 8);
+        return Pixelsi(std::vector<int>(l.getData().size(), shift / 4), l.getWidth(), l.getHeight());
+    };
+    for (const auto kernels : Kernels::available()) {
+        const auto map = Pyramid::calcDepthMap(left, right, window, 8, 32, 3, 2, false, fullSearch, *kernels);
+        for (int row = 0; row < height; ++row) {
+            for (int col = shift + window; col < width; ++col) {
+                CHECK(map.get(row, col) == shift);
+            }
+        }
+    }
+    CHECK(fullSearches == Kernels::available().size());
+}
+#endif
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <vector>
+#include "Sgm.hpp"
+#include "Workers.hpp"
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "../thirdparty/doctest.h"
+#endif
+
+
+namespace {
+
+/// Path costs beyond the disparity range, larger than any real one, but far from overflowing when penalized.
+constexpr float OUTSIDE = 1e30f;
+
+
+/// A path direction, the predecessor of pixel `(row, col)` on the path is `(row - dy, col - dx)`.
+struct Path {
+    int dx;
+    int dy;
+};
+
+/// The first 4 are the horizontal and vertical paths, the rest are diagonal.
+const Path PATHS[] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { -1, 1 }, { 1, -1 }, { -1, -1 } };
+
+
+/// Path costs of a row of pixels. Every pixel is padded by an `OUTSIDE` element on both sides.
+class PathRow {
+public:
+    PathRow(int width, int disparities) :
+            m_disparities   (disparities),
+            m_costs         (static_cast<size_t>(width) * (disparities + 2), OUTSIDE),
+            m_minimums      (width, 0.0f)
+    {}
+
+    float*  costs   (int col) { return &m_costs[static_cast<size_t>(col) * (m_disparities + 2) + 1]; }
+    float&  minimum (int col) { return m_minimums[col]; }
+
+private:
+    int m_disparities;
+    std::vector<float> m_costs;
+    std::vector<float> m_minimums;
+};
+
+
+/// The predecessor of the first pixel of a path, its costs are 0.
+PathRow pathStart(int disparities) {
+    PathRow start(1, disparities);
+    std::fill(start.costs(0), start.costs(0) + disparities, 0.0f);
+    return start;
+}
+
+
+/// Runs a horizontal path along a row.
+void aggregateRow(const CostVolume& volume, int row, int dx, const Sgm::Penalties& penalties,
+                  const Kernels::Table& kernels, float* sums) {
+    const int width = volume.getWidth();
+    const int disparities = volume.getMaxD() - volume.getMinD();
+    PathRow start = pathStart(disparities);
+    PathRow buffers(2, disparities);
+
+    const float* previous = start.costs(0);
+    float previousMin = 0.0f;
+    for (int i = 0; i < width; ++i) {
+        const int col = dx > 0 ? i : width - 1 - i;
+        float* current = buffers.costs(i % 2);
+        previousMin = kernels.sgmStep(volume.pixelScores(row, col), previous, previousMin, disparities,
+                                      penalties.p1, penalties.p2, current, sums + static_cast<size_t>(col) * disparities);
+        previous = current;
+    }
+}
+
+
+/// Runs a vertical or diagonal path through the image, a row at a time.
+void aggregateRows(const CostVolume& volume, const Path& path, const Sgm::Penalties& penalties,
+                   const Kernels::Table& kernels, float* sums) {
+    const int width = volume.getWidth();
+    const int height = volume.getHeight();
+    const int disparities = volume.getMaxD() - volume.getMinD();
+    PathRow start = pathStart(disparities);
+    PathRow previousRow(width, disparities);
+    PathRow currentRow(width, disparities);
+
+    for (int i = 0; i < height; ++i) {
+        const int row = path.dy > 0 ? i : height - 1 - i;
+        for (int col = 0; col < width; ++col) {
+            const int previousCol = col - path.dx;
+            const bool first = i == 0 || previousCol < 0 || previousCol >= width;
+            const float* previous = first ? start.costs(0) : previousRow.costs(previousCol);
+            const float previousMin = first ? 0.0f : previousRow.minimum(previousCol);
+            currentRow.minimum(col) = kernels.sgmStep(volume.pixelScores(row, col), previous, previousMin, disparities,
+                                                      penalties.p1, penalties.p2, currentRow.costs(col),
+                                                      sums + (static_cast<size_t>(row) * width + col) * disparities);
+        }
+        std::swap(previousRow, currentRow);
+    }
+}
+
+
+/// The number of buffers the paths crossing the rows are summed into, one per thread.
+int pathGroups(int paths) {
+    return std::max(1, std::min(CliOptions::getThreads(), paths - 2));
+}
+
+}
+
+
+DepthMaps Sgm::calcDepthMaps(const CostVolume& volume, int paths, const Penalties& penalties,
+                             const Kernels::Table& kernels) {
+    if (volume.getStorage() != CostVolume::Storage::Float32 || volume.getLayout() != CostVolume::Layout::DisparityInner
+        || (paths != 4 && paths != 8)) {
+        throw std::exception();
+    }
+    const int width = volume.getWidth();
+    const int height = volume.getHeight();
+    const int minD = volume.getMinD();
+    const int disparities = volume.getMaxD() - minD;
+    const size_t rowSize = static_cast<size_t>(width) * disparities;
+
+    std::vector<float> sums(rowSize * height, 0.0f);
+    Workers::forEachBand(height, [&](int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+            aggregateRow(volume, row, 1, penalties, kernels, &sums[row * rowSize]);
+            aggregateRow(volume, row, -1, penalties, kernels, &sums[row * rowSize]);
+        }
+    });
+
+    // the paths crossing the rows depend on the previous row, so they are split between the threads instead,
+    // the first group sums into the final buffer, the others into their own ones
+    std::vector<std::vector<float>> groupSums(pathGroups(paths));
+    const int groups = static_cast<int>(groupSums.size());
+    Workers::forEachBand(groups, [&](int begin, int end) {
+        for (int group = begin; group < end; ++group) {
+            float* target = sums.data();
+            if (group > 0) {
+                groupSums[group].assign(sums.size(), 0.0f);
+                target = groupSums[group].data();
+            }
+            for (int i = 2 + group; i < paths; i += groups) {
+                aggregateRows(volume, PATHS[i], penalties, kernels, target);
+            }
+        }
+    });
+    Workers::forEachBand(height, [&](int begin, int end) {
+        for (int group = 1; group < groups; ++group) {
+            for (size_t i = begin * rowSize; i < end * rowSize; ++i) {
+                sums[i] += groupSums[group][i];
+            }
+        }
+    });
+
+    std::vector<int> left(rowSize / disparities * height, minD);
+    std::vector<int> right(rowSize / disparities * height, minD);
+    Workers::forEachBand(height, [&](int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+            const float* rowSums = &sums[row * rowSize];
+            for (int col = 0; col < width; ++col) {
+                float leftBest = rowSums[col * disparities];
+                float rightBest = OUTSIDE;
+                for (int d = 0; d < disparities; ++d) {
+                    if (rowSums[col * disparities + d] < leftBest) {
+                        leftBest = rowSums[col * disparities + d];
+                        left[row * width + col] = minD + d;
+                    }
+                    // right pixel col pairs with the left pixel col + disparity
+                    const int leftCol = col + minD + d;
+                    if (leftCol < width && rowSums[leftCol * disparities + d] < rightBest) {
+                        rightBest = rowSums[leftCol * disparities + d];
+                        right[row * width + col] = minD + d;
+                    }
+                }
+            }
+        }
+    });
+
+    return { Pixelsi(std::move(left), width, height), Pixelsi(std::move(right), width, height) };
+}
+
+
+size_t Sgm::bytesRequired(const CostVolume& volume, int paths) {
+    const size_t size = CostVolume::bytesRequired(volume.getWidth(), volume.getHeight(),
+                                                  volume.getMaxD() - volume.getMinD(), CostVolume::Storage::Float32);
+    return size * pathGroups(paths);
+}
+
+
+
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+TEST_CASE("check if the aggregation fills in a pixel with a wrong best score") {
+    const int width = 12, height = 10, minD = 1, maxD = 7;
+    CostVolume volume(width, height, minD, maxD, CostVolume::Layout::DisparityInner, CostVolume::Storage::Float32);
+    for (int row = 0; row < height; ++row) {
+        for (int col = 0; col < width; ++col) {
+            for (int disp = minD; disp < maxD; ++disp) {
+                volume.set(row, col, disp, disp == 4 ? 0.8f : 0.2f);
+            }
+        }
+    }
+    // an outlier in the middle, preferring disparity 2 a little
+    for (int disp = minD; disp < maxD; ++disp) {
+        volume.set(5, 6, disp, disp == 2 ? 0.9f : 0.2f);
+    }
+
+    for (const auto kernels : Kernels::available()) {
+        for (int paths : { 4, 8 }) {
+            const auto maps = Sgm::calcDepthMaps(volume, paths, { 0.1f, 1.0f }, *kernels);
+            for (int row = 0; row < height; ++row) {
+                for (int col = 0; col < width; ++col) {
+                    CHECK(maps.left.get(row, col) == 4);
+                    if (col + 4 < width) {
+                        CHECK(maps.right.get(row, col) == 4);
+                    }
+                }
+            }
+        }
+    }
+    // without smoothing the outlier wins
+    const auto raw = Sgm::calcDepthMaps(volume, 4, { 0.0f, 0.0f }, *Kernels::available().front());
+    CHECK(raw.left.get(5, 6) == 2);
+}
+#endif
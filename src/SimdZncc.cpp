@@ -0,0 +1,108 @@
+#include "SimdZncc.hpp"
+#include "Kernels.hpp"
+#include "Workers.hpp"
+
+
+namespace {
+
+/// Raw view of the planes of an image. The kernels read the apron of the planes as row padding.
+Kernels::PlaneRows planeRows(const PixelCalc& calc, int border) {
+    if (calc.centered().getApron() < border || calc.invStds().getApron() < border) {
+        throw std::exception();
+    }
+    return { calc.centered().getRow(0), calc.invStds().getRow(0), static_cast<int>(calc.pixels().getHeight()),
+             calc.centered().getStride() };
+}
+
+
+/// Raw view of the window cache of an image.
+Kernels::WindowPlanes windowPlanes(const PixelCalc& calc, int window, int border) {
+    const auto& cache = calc.windowCache();
+    if (cache.window() != window || cache.apron() < border) {
+        throw std::exception();
+    }
+    return { cache.plane(0), cache.planeSize(), cache.stride() };
+}
+
+
+using RowKernel = decltype(Kernels::Matchers::matchRowLanes);
+
+
+Pixelsi matchRows(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD, int maxD,
+                  RowKernel kernel) {
+    const int width = leftCalc.pixels().getWidth();
+    const int height = leftCalc.pixels().getHeight();
+    const int r = window / 2;
+    const auto left = planeRows(leftCalc, r);
+    const auto right = planeRows(rightCalc, r + maxD);
+
+    std::vector<int> result(static_cast<size_t>(width) * height);
+    Workers::forEachBand(height, [&](int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+            kernel(left, right, row, width, window, minD, maxD, &result[row * width]);
+        }
+    });
+
+    return Pixelsi(std::move(result), width, height);
+}
+
+}
+
+
+Pixelsi SimdZncc::calcDepthMapDisparityLanes(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window,
+                                             int minD, int maxD, bool invertD, const Kernels::Table& kernels) {
+    return matchRows(leftCalc, rightCalc, window, minD, maxD,
+                     kernels.matchers(window, invertD).matchDisparityLanes);
+}
+
+
+Pixelsi SimdZncc::calcDepthMapRowLanes(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD,
+                                       int maxD, bool invertD, const Kernels::Table& kernels) {
+    return matchRows(leftCalc, rightCalc, window, minD, maxD, kernels.matchers(window, invertD).matchRowLanes);
+}
+
+
+Pixelsi SimdZncc::calcDepthMapCachedRowLanes(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window,
+                                             int minD, int maxD, bool invertD, const Kernels::Table& kernels) {
+    const int width = leftCalc.pixels().getWidth();
+    const int height = leftCalc.pixels().getHeight();
+    const int r = window / 2;
+    const auto left = planeRows(leftCalc, r);
+    const auto right = planeRows(rightCalc, r + maxD);
+    // the cached windows already include the columns of the window radius
+    const auto leftWindows = windowPlanes(leftCalc, window, 0);
+    const auto rightWindows = windowPlanes(rightCalc, window, maxD);
+    const auto kernel = kernels.matchers(window, invertD).matchRowLanesCached;
+
+    std::vector<int> result(static_cast<size_t>(width) * height);
+    Workers::forEachBand(height, [&](int begin, int end) {
+        for (int row = begin; row < end; ++row) {
+            kernel(left, right, leftWindows, rightWindows, row, width, window, minD, maxD, &result[row * width]);
+        }
+    });
+
+    return Pixelsi(std::move(result), width, height);
+}
+
+
+DepthMaps SimdZncc::calcDepthMapsRowLanes(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window,
+                                          int minD, int maxD, const Kernels::Table& kernels) {
+    const int width = leftCalc.pixels().getWidth();
+    const int height = leftCalc.pixels().getHeight();
+    const int r = window / 2;
+    const auto left = planeRows(leftCalc, r);
+    const auto right = planeRows(rightCalc, r + maxD);
+    const auto kernel = kernels.matchers(window, false).matchRowLanesBoth;
+
+    std::vector<int> leftResult(static_cast<size_t>(width) * height);
+    std::vector<int> rightResult(static_cast<size_t>(width) * height);
+    Workers::forEachBand(height, [&](int begin, int end) {
+        std::vector<float> scratch(2 * static_cast<size_t>(width));
+        for (int row = begin; row < end; ++row) {
+            kernel(left, right, row, width, window, minD, maxD, &leftResult[row * width], &rightResult[row * width],
+                   scratch.data());
+        }
+    });
+
+    return { Pixelsi(std::move(leftResult), width, height), Pixelsi(std::move(rightResult), width, height) };
+}
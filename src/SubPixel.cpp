@@ -0,0 +1,127 @@
+#include <map>
+#include <cmath>
+#include "SubPixel.hpp"
+#include "Workers.hpp"
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "../thirdparty/doctest.h"
+#endif
+
+
+SubPixel::Method SubPixel::parse(const std::string& name) {
+    const std::map<std::string, Method> METHODS = {
+            { "none",           Method::None },
+            { "parabola",       Method::Parabola },
+            { "equiangular",    Method::Equiangular },
+    };
+    const auto it = METHODS.find(name);
+    if (it == METHODS.end()) {
+        throw std::exception();
+    }
+    return it->second;
+}
+
+
+float SubPixel::offset(Method method, float below, float best, float above) {
+    float denominator = 0.0f;
+    switch (method) {
+        case Method::Parabola:
+            denominator = 2.0f * (2.0f * best - below - above);
+            break;
+        case Method::Equiangular:
+            // the lower neighbour lies on the steeper line
+            denominator = 2.0f * (best - std::min(below, above));
+            break;
+        default:
+            return 0.0f;
+    }
+    if (denominator <= 0.0f) {
+        return 0.0f;
+    }
+    return std::max(-0.5f, std::min(0.5f, (above - below) / denominator));
+}
+
+
+Pixelsf SubPixel::refine(const PixelCalc& leftCalc, const PixelCalc& rightCalc, const Pixelsi& depthMap, int minD,
+                         int maxD, bool invertD, MatchingCost::Kind cost, Method method) {
+    const int window = leftCalc.window();
+    const int width = depthMap.getWidth();
+    const int height = depthMap.getHeight();
+    if (leftCalc.apron() < window / 2 || rightCalc.apron() < window / 2 + maxD) {
+        throw std::exception();
+    }
+
+    std::vector<float> result(depthMap.getData().begin(), depthMap.getData().end());
+    if (method == Method::None) {
+        return Pixelsf(std::move(result), width, height);
+    }
+    MatchingCost::dispatch(cost, [&](auto costType) {
+        using Cost = std::remove_pointer_t<decltype(costType)>;
+        Workers::forEachBand(height, [&](int begin, int end) {
+            Cost bandCost(leftCalc, rightCalc, Kernels::active());
+            std::vector<float> terms(window);
+            auto score = [&](int col, int row, int disp) {
+                return MatchingCost::windowScore(bandCost, window, col, row, invertD ? -disp : disp, terms.data());
+            };
+            for (int row = begin; row < end; ++row) {
+                for (int col = 0; col < width; ++col) {
+                    const int disp = depthMap.getUnclamped(row, col);
+                    if (disp <= minD || disp >= maxD - 1) {
+                        continue;
+                    }
+                    result[row * width + col] += offset(method, score(col, row, disp - 1), score(col, row, disp),
+                                                        score(col, row, disp + 1));
+                }
+            }
+        });
+    });
+    return Pixelsf(std::move(result), width, height);
+}
+
+
+
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+TEST_CASE("check if the curves find the peak of the scores") {
+    for (auto method : { SubPixel::Method::Parabola, SubPixel::Method::Equiangular }) {
+        CHECK(SubPixel::offset(method, 1.0f, 2.0f, 1.0f) == 0.0f);
+        CHECK(SubPixel::offset(method, 2.0f, 2.0f, 2.0f) == 0.0f);
+        CHECK(SubPixel::offset(method, -5.0f, 2.0f, 1.0f) > 0.0f);
+        CHECK(SubPixel::offset(method, 1.0f, 2.0f, -5.0f) < 0.0f);
+    }
+    // -(x - 0.25)^2 sampled at -1, 0, 1
+    CHECK(SubPixel::offset(SubPixel::Method::Parabola, -1.5625f, -0.0625f, -0.5625f) == doctest::Approx(0.25f));
+    // -|x - 0.25| sampled at -1, 0, 1
+    CHECK(SubPixel::offset(SubPixel::Method::Equiangular, -1.25f, -0.25f, -0.75f) == doctest::Approx(0.25f));
+}
+
+TEST_CASE("check if the refinement finds a fractional shift") {
+    // smooth waves shifted by a fraction of a pixel, SSD is close to a parabola around the match
+    const int width = 64, height = 12, window = 7, minD = 0, maxD = 10;
+    const float shift = 4.25f;
+    auto wave = [](float x, int row) {
+        return 100.0f + 60.0f * std::sin(x * 0.45f + row * 0.3f) + 30.0f * std::sin(x * 0.17f);
+    };
+    std::vector<float> leftData(width * height), rightData(width * height);
+    for (int row = 0; row < height; ++row) {
+        for (int col = 0; col < width; ++col) {
+            rightData[row * width + col] = wave(static_cast<float>(col), row);
+            leftData[row * width + col] = wave(col - shift, row);
+        }
+    }
+    const Pixelsf left (std::move(leftData), width, height);
+    const Pixelsf right (std::move(rightData), width, height);
+
+    const auto cost = MatchingCost::Kind::Ssd;
+    const int apron = window / 2 + maxD;
+    const auto leftCalc = PixelCalc::calculatePixelCalc(left, window, apron, MatchingCost::planes(cost));
+    const auto rightCalc = PixelCalc::calculatePixelCalc(right, window, apron, MatchingCost::planes(cost));
+    std::vector<int> integerData(width * height, 4);
+    const Pixelsi integerMap(std::move(integerData), width, height);
+    const auto map = SubPixel::refine(leftCalc, rightCalc, integerMap, minD, maxD, false, cost,
+                                      SubPixel::Method::Parabola);
+    for (int row = 0; row < height; ++row) {
+        for (int col = maxD + window; col < width - window; ++col) {
+            CHECK(map.get(row, col) == doctest::Approx(shift).epsilon(0.02));
+        }
+    }
+}
+#endif
@@ -0,0 +1,44 @@
+#include "WindowCache.hpp"
+#include "Workers.hpp"
+
+
+constexpr size_t WindowCache::ALIGNMENT;
+
+
+namespace {
+
+constexpr int FLOATS_PER_ALIGNMENT = WindowCache::ALIGNMENT / sizeof(float);
+
+
+int roundToAlignment(int count) {
+    return (count + FLOATS_PER_ALIGNMENT - 1) / FLOATS_PER_ALIGNMENT * FLOATS_PER_ALIGNMENT;
+}
+
+}
+
+
+WindowCache::WindowCache(const Pixelsf& pixels, int window, int apron, Memory::Arena& arena) :
+    m_window    (window),
+    m_apron     (apron),
+    m_offset    (roundToAlignment(apron)),
+    m_stride    (roundToAlignment(m_offset + static_cast<int>(pixels.getWidth()) + apron)),
+    m_planeSize (static_cast<size_t>(m_stride) * pixels.getHeight()),
+    m_data      (arena.allocate<float>(m_planeSize * window * window))
+{
+    const int height = pixels.getHeight();
+    const int D = window / 2;
+    Workers::forEachBand(height, [&](int begin, int end) {
+        for (int element = 0; element < window * window; ++element) {
+            const int dy = element / window - D;
+            const int dx = element % window - D;
+            float* planeData = m_data + element * m_planeSize;
+            for (int row = begin; row < end; ++row) {
+                // the padding around the apron repeats the edge values too, so whole vectors can be read
+                float* planeRow = planeData + static_cast<size_t>(row) * m_stride;
+                for (int col = 0; col < m_stride; ++col) {
+                    planeRow[col] = pixels.get(row + dy, col - m_offset + dx);
+                }
+            }
+        }
+    });
+}
@@ -0,0 +1,242 @@
+#include "WindowSweep.hpp"
+#include "Workers.hpp"
+#include "Memory.hpp"
+#include <cstdlib>
+#ifdef _MSC_VER
+#include <xmmintrin.h>
+#endif
+
+
+namespace {
+
+constexpr int CACHE_LINE = 64;
+
+// the best scores kept per pixel for the confidence, the second best excludes at most 3 of them
+constexpr int TOP = 4;
+
+
+/// Hints the cache to load `[data, data + bytes)`.
+void prefetch(const void* data, size_t bytes) {
+    const char* bytePtr = static_cast<const char*>(data);
+    for (size_t offset = 0; offset < bytes; offset += CACHE_LINE) {
+#ifdef _MSC_VER
+        _mm_prefetch(bytePtr + offset, _MM_HINT_T1);
+#else
+        __builtin_prefetch(bytePtr + offset, 0, 2);
+#endif
+    }
+}
+
+
+/// Prefetches the columns `[col, col + count)` of a row of the planes a cost reads.
+template<typename Tcost>
+void prefetchRow(const PixelCalc& calc, int row, int col, int count) {
+    if (Tcost::PLANES & PixelCalc::StatisticsPlanes) {
+        prefetch(calc.centered().getRow(row) + col, count * sizeof(float));
+        prefetch(calc.invStds().getRow(row) + col, count * sizeof(float));
+    }
+    if (Tcost::PLANES & PixelCalc::PaddedPlane) {
+        prefetch(calc.padded().getRow(row) + col, count * sizeof(float));
+    }
+    if (Tcost::PLANES & PixelCalc::CensusPlanes) {
+        for (const auto& plane : calc.census()) {
+            prefetch(plane.getRow(row) + col, count * sizeof(uint64_t));
+        }
+    }
+}
+
+
+/// Gets the bytes of the planes a cost reads per pixel.
+int planeBytes(MatchingCost::Kind cost, int window) {
+    switch (cost) {
+        case MatchingCost::Kind::Zncc:
+            return 2 * sizeof(float);
+        case MatchingCost::Kind::Census:
+            return Census::descriptorWords(window) * sizeof(uint64_t);
+        default:
+            return sizeof(float);
+    }
+}
+
+/// Inserts a score into the `TOP` best scores of a pixel, kept in decreasing order. An equal score stays after
+/// the earlier ones, so the first entry is the disparity `calcDepthMap` chooses.
+void insertTop(float* scores, int* disps, float score, int disp) {
+    if (!(score > scores[TOP - 1])) {
+        return;
+    }
+    int i = TOP - 1;
+    for (; i > 0 && score > scores[i - 1]; --i) {
+        scores[i] = scores[i - 1];
+        disps[i] = disps[i - 1];
+    }
+    scores[i] = score;
+    disps[i] = disp;
+}
+
+
+/// Scores the rows `[begin, end)` at every disparity, and stores the best disparities of the band. While sweeping
+/// the last disparity, prefetches the plane rows the first windows of the rows `[nextBegin, nextEnd)` read.
+/// If `confidence` is not null, also tracks the `TOP` best scores, and stores the confidence of the band.
+template<typename Tcost>
+void sweepBand(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD, int maxD, bool invertD,
+               int begin, int end, int nextBegin, int nextEnd, int* result, float* confidence) {
+    const int width = leftCalc.pixels().getWidth();
+    const int r = window / 2;
+    // a term row covers the columns [-r, width + r)
+    const int span = width + 2 * r;
+    Tcost cost(leftCalc, rightCalc, Kernels::active());
+    // the buffers of the previous tile of the thread are reused
+    thread_local Memory::Arena arena;
+    arena.reset();
+    const size_t bandSize = static_cast<size_t>(end - begin) * width;
+    float* termRows = arena.allocate<float>(static_cast<size_t>(window) * span);
+    float* sums = arena.allocate<float>(width);
+    float* bestScores = arena.allocate<float>(bandSize);
+    float* topScores = confidence ? arena.allocate<float>(bandSize * TOP) : nullptr;
+    int* topDisps = confidence ? arena.allocate<int>(bandSize * TOP) : nullptr;
+    std::fill_n(bestScores, bandSize, Tcost::WORST);
+    if (confidence) {
+        std::fill_n(topScores, bandSize * TOP, Tcost::WORST);
+        std::fill_n(topDisps, bandSize * TOP, minD);
+    }
+
+    // the ring slot of an image row, the rows of a window are in distinct slots
+    auto termRow = [&](int row) {
+        return &termRows[static_cast<size_t>((row % window + window) % window) * span];
+    };
+
+    for (int disp = minD; disp < maxD; ++disp) {
+        const int d = invertD ? -disp : disp;
+        for (int row = begin - r; row < begin + r; ++row) {
+            cost.terms(row, -r, d, span, termRow(row));
+        }
+        for (int row = begin; row < end; ++row) {
+            // replaces the row above the window
+            cost.terms(row + r, -r, d, span, termRow(row + r));
+
+            // the terms of a window are added row by row, left to right, as in a single window evaluation
+            std::fill_n(sums, width, 0.0f);
+            for (int y = row - r; y <= row + r; ++y) {
+                const float* terms = termRow(y);
+                for (int i = 0; i < window; ++i) {
+                    for (int col = 0; col < width; ++col) {
+                        sums[col] += terms[col + i];
+                    }
+                }
+            }
+
+            float* rowBest = &bestScores[static_cast<size_t>(row - begin) * width];
+            int* rowResult = &result[row * width];
+            if (confidence) {
+                const size_t rowTop = static_cast<size_t>(row - begin) * width * TOP;
+                for (int col = 0; col < width; ++col) {
+                    const float score = cost.score(sums[col], row, col, d);
+                    if (score > rowBest[col]) {
+                        rowBest[col] = score;
+                        rowResult[col] = disp;
+                    }
+                    insertTop(&topScores[rowTop + col * TOP], &topDisps[rowTop + col * TOP], score, disp);
+                }
+            } else {
+                for (int col = 0; col < width; ++col) {
+                    const float score = cost.score(sums[col], row, col, d);
+                    if (score > rowBest[col]) {
+                        rowBest[col] = score;
+                        rowResult[col] = disp;
+                    }
+                }
+            }
+
+            // a row of the next band per row, starting with the rows of its first window at the first disparity
+            const int nextRow = nextBegin - r + (row - begin);
+            if (disp == maxD - 1 && nextBegin < nextEnd && nextRow < nextEnd + r) {
+                prefetchRow<Tcost>(leftCalc, nextRow, -r, span);
+                prefetchRow<Tcost>(rightCalc, nextRow, -r - (invertD ? -minD : minD), span);
+            }
+        }
+    }
+
+    if (confidence) {
+        for (size_t i = 0; i < bandSize; ++i) {
+            // the scores next to the best disparity are not counted, they fall off smoothly around a match
+            const int bestD = result[begin * width + i];
+            float secondScore = Tcost::WORST;
+            for (int k = 1; k < TOP; ++k) {
+                if (std::abs(topDisps[i * TOP + k] - bestD) > 1) {
+                    secondScore = topScores[i * TOP + k];
+                    break;
+                }
+            }
+            // the distances of the scores from a perfect match, the best one is the shorter by the confidence
+            const float best = Tcost::PERFECT - bestScores[i];
+            const float second = Tcost::PERFECT - secondScore;
+            confidence[begin * width + i] = second > 0.0f ? std::max(0.0f, std::min(1.0f, 1.0f - best / second))
+                                                          : 0.0f;
+        }
+    }
+}
+
+
+/// Runs `sweepBand` on every row, by bands or by tiles.
+void sweep(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD, int maxD, bool invertD,
+           MatchingCost::Kind cost, int tile, int* result, float* confidence) {
+    const int height = leftCalc.pixels().getHeight();
+    if (leftCalc.apron() < window / 2 || rightCalc.apron() < window / 2 + maxD) {
+        throw std::exception();
+    }
+
+    MatchingCost::dispatch(cost, [&](auto costType) {
+        using Cost = std::remove_pointer_t<decltype(costType)>;
+        if (tile > 0) {
+            Workers::forEachTile(height, tile, [&](int begin, int end, int nextBegin, int nextEnd) {
+                sweepBand<Cost>(leftCalc, rightCalc, window, minD, maxD, invertD, begin, end, nextBegin, nextEnd,
+                                result, confidence);
+            });
+        } else {
+            Workers::forEachBand(height, [&](int begin, int end) {
+                sweepBand<Cost>(leftCalc, rightCalc, window, minD, maxD, invertD, begin, end, end, end, result,
+                                confidence);
+            });
+        }
+    });
+}
+
+}
+
+
+int WindowSweep::tileRows(int width, int height, int window, int maxD, MatchingCost::Kind cost, size_t cacheBytes) {
+    const int r = window / 2;
+    const size_t span = width + 2 * r;
+    const size_t bytes = planeBytes(cost, window);
+    // a tile row adds its best scores and disparities, a left plane row, and a right plane row with the search span
+    const size_t rowBytes = width * (sizeof(float) + sizeof(int)) + (2 * span + maxD) * bytes;
+    // the term ring, the window sums, and the plane rows of the windows reaching over the tile edges
+    const size_t fixedBytes = window * span * sizeof(float) + width * sizeof(float) + 2 * r * (2 * span + maxD) * bytes;
+    // half of the cache is left to the other data of the core
+    const size_t budget = cacheBytes / 2;
+    const int rows = budget > fixedBytes ? static_cast<int>((budget - fixedBytes) / rowBytes) : 0;
+    // thinner tiles would spend more on the terms of the rows above and below them than on their own
+    return std::max(1, std::min(height, std::max(window, rows)));
+}
+
+
+Pixelsi WindowSweep::calcDepthMap(const PixelCalc& leftCalc, const PixelCalc& rightCalc, int window, int minD,
+                                  int maxD, bool invertD, MatchingCost::Kind cost, int tile) {
+    const int width = leftCalc.pixels().getWidth();
+    const int height = leftCalc.pixels().getHeight();
+    std::vector<int> result(static_cast<size_t>(width) * height, minD);
+    sweep(leftCalc, rightCalc, window, minD, maxD, invertD, cost, tile, result.data(), nullptr);
+    return Pixelsi(std::move(result), width, height);
+}
+
+
+ConfidentDepthMap WindowSweep::calcConfidentDepthMap(const PixelCalc& leftCalc, const PixelCalc& rightCalc,
+                                                     int window, int minD, int maxD, bool invertD,
+                                                     MatchingCost::Kind cost, int tile) {
+    const int width = leftCalc.pixels().getWidth();
+    const int height = leftCalc.pixels().getHeight();
+    std::vector<int> result(static_cast<size_t>(width) * height, minD);
+    std::vector<float> confidence(result.size());
+    sweep(leftCalc, rightCalc, window, minD, maxD, invertD, cost, tile, result.data(), confidence.data());
+    return { Pixelsi(std::move(result), width, height), Pixelsf(std::move(confidence), width, height) };
+}
@@ -4,24 +4,100 @@
 #include "Disparity.hpp"
 #include "PixelUtils.hpp"
 #include "CliOptions.hpp"
+#include "Calibration.hpp"
+#include "Memory.hpp"
 
 
 #ifndef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 
+namespace {
+
+template<typename T>
+void processImages(const Pixels<T>& greyPx1, const Pixels<T>& greyPx2, const DisparityRange& range) {
+    using namespace DisparityAlgorithm;
+
+    const auto depthmaps = calcDepthMaps(greyPx1, greyPx2, range);
+    // the planes of the matching job are gone, the next job reuses the arena chunk
+    Memory::jobArena().reset();
+
+    const auto crossChecked = normalize(crossCheck(depthmaps.left, depthmaps.right), range);
+    PixelUtils::save(occlusionFill(crossChecked), "occluded.png");
+}
+
+
+/// Matches both images, and refines their disparities to fractions of a pixel before the cross-check.
+void processImagesSubPixel(const Pixelsf& greyPx1, const Pixelsf& greyPx2, const DisparityRange& range) {
+    using namespace DisparityAlgorithm;
+
+    const auto depthmaps = calcDepthMaps(greyPx1, greyPx2, range);
+    // the planes of the matching job are gone, the next job reuses the arena chunk
+    Memory::jobArena().reset();
+    const auto left = refineDepthMap(greyPx1, greyPx2, depthmaps.left, range, false);
+    const auto right = refineDepthMap(greyPx2, greyPx1, depthmaps.right, range, true);
+
+    const auto crossChecked = normalize(crossCheck(left, right), range);
+    PixelUtils::save(occlusionFill(crossChecked), "occluded.png");
+}
+
+
+/// Matches only the left image, and validates it by the confidence of its disparities.
+void processImagesUnique(const Pixelsf& greyPx1, const Pixelsf& greyPx2, const DisparityRange& range) {
+    using namespace DisparityAlgorithm;
+
+    const auto depthmap = calcConfidentDepthMap(greyPx1, greyPx2, range);
+
+    std::vector<int> confidence(depthmap.confidence.getData().size());
+    for (int i = 0; i < confidence.size(); ++i) {
+        confidence[i] = static_cast<int>(depthmap.confidence.getData()[i] * 255.0f);
+    }
+    PixelUtils::save(Pixelsi(std::move(confidence), depthmap.confidence.getWidth(), depthmap.confidence.getHeight()),
+                     "confidence.png");
+
+    const auto checked = uniquenessCheck(depthmap.disparities, depthmap.confidence, CliOptions::getUniqueness());
+    if (CliOptions::getSubPixel() != "none") {
+        // the invalid pixels stay 0, their neighbour scores are not searched
+        PixelUtils::save(occlusionFill(normalize(refineDepthMap(greyPx1, greyPx2, checked, range, false), range)),
+                         "occluded.png");
+        return;
+    }
+    PixelUtils::save(occlusionFill(normalize(checked, range)), "occluded.png");
+}
+
+}
+
+
 int main(int argc, const char* argv[]) {
     CliOptions::parse(argc, argv);
     Logger::logInit();
 
-    using namespace DisparityAlgorithm;
+    const int factor = CliOptions::getDownscale();
+    const auto calibration = Calibration::load("calib.txt");
+    const auto range = calibration.range(factor);
+    Logger::logCalibration("calib.txt", calibration.loaded(), range.min, range.max);
 
-    const auto greyPx1 = PixelUtils::loadGrey("im0.png");
-    const auto greyPx2 = PixelUtils::loadGrey("im1.png");
+    if (CliOptions::getEngine() == CliOptions::Engine::Integer && !CliOptions::getBenchmark()) {
+        processImages(PixelUtils::loadGrey8("im0.png", factor), PixelUtils::loadGrey8("im1.png", factor), range);
+        return 0;
+    }
 
-    const auto depth1 = calcDepthMap(greyPx1, greyPx2, false);
-    const auto depth2 = calcDepthMap(greyPx2, greyPx1, true);
+    const auto greyPx1 = PixelUtils::loadGrey("im0.png", factor);
+    const auto greyPx2 = PixelUtils::loadGrey("im1.png", factor);
 
-    const auto crossChecked = normalize(crossCheck(depth1, depth2));
-    PixelUtils::save(occlusionFill(crossChecked), "occluded.png");
+    if (CliOptions::getBenchmark()) {
+        DisparityAlgorithm::benchmarkKernels(greyPx1, greyPx2, range);
+        return 0;
+    }
+
+    if (CliOptions::getUniqueness() > 0.0f) {
+        processImagesUnique(greyPx1, greyPx2, range);
+        return 0;
+    }
+    if (CliOptions::getSubPixel() != "none") {
+        processImagesSubPixel(greyPx1, greyPx2, range);
+        return 0;
+    }
+
+    processImages(greyPx1, greyPx2, range);
 
     return 0;
 }